@@ -3,10 +3,13 @@
 #include <vector>
 #include <stdio.h>
 
-LongMult::LongMult(int n, bool useXorClauses)
+LongMult::LongMult(int n, bool useXorClauses, Formula::TreeType tree, Formula::AdderType adder)
 {
     N = n;
+    treeType = tree;
     if ( useXorClauses ) cnf.setUseXORClauses();
+    if ( tree != Formula::TT_NONE ) cnf.setTreeType(tree);
+    cnf.setAdderType(adder);
 
     encode();
 }
@@ -29,6 +32,18 @@ void LongMult::encode()
         for( int i=0; i<N; i++ )
             cnf.and2(&table[j][i], &X[i], &Y[j], 1);
 
+    if ( treeType != Formula::TT_NONE )
+    {
+        vector<vector<int>> cols(2*N);
+        for( int i=0; i<N; i++ )
+            for( int j=0; j<N; j++ )
+                cols[j+i].push_back(table[i][j]);
+
+        cnf.newVars(Z, 2*N);
+        cnf.addColumns(Z, cols);
+        return;
+    }
+
     vector<queue<int>> m(2*N);
 
     for( int i=0; i<N; i++ )
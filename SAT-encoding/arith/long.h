@@ -9,9 +9,13 @@ using namespace std;
 
 class LongMult {
     public:
+        /** tree TT_NONE compresses the columns one after the other with
+         *  full/half adders until a single row is left */
         LongMult(
                 int n = 32,
-                bool useXorClauses = false);
+                bool useXorClauses = false,
+                Formula::TreeType tree = Formula::TT_NONE,
+                Formula::AdderType adder = Formula::RIPPLE_CARRY);
         ~LongMult();
 
         void encode();
@@ -22,6 +26,7 @@ class LongMult {
         int Y[MAX_WIDTH];
         int Z[2*MAX_WIDTH];
         int N;
+        Formula::TreeType treeType;
 
         Formula cnf;
 };
@@ -1,40 +1,190 @@
 #include "long.h"
 #include "mod.h"
 #include "ppa.h"
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
 
-#define TEST3
+enum ProblemType {
+    PT_LONG,
+    PT_MOD,
+    PT_PPA,
+    PT_NONE
+};
 
-int main()
+/* config options */
+ProblemType cfg_problem;
+int cfg_bits;
+const char *cfg_target;
+int cfg_use_xor_clauses;
+Formula::TreeType cfg_tree;
+Formula::AdderType cfg_adder;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options]\n"
+            "  --help or -h                             Prints this message\n"
+            "  --problem or -p {long | mod | ppa}       a*b, (a*b) mod (2^n-1) or a+b (default: ppa)\n"
+            "  --bits or -n {int}                       Width of the operands (default: 8)\n"
+            "  --target or -t {decimal}                 Value the result is fixed to (default: 171)\n"
+            "  --tree or -T {array | wallace | dadda | compressor42}\n"
+            "                                           Reduction of the partial products of long (default: array)\n"
+            "  --carry or -C {ripple | kogge_stone | brent_kung}\n"
+            "                                           Final adder of the long trees, adder of ppa (default: ripple / kogge_stone)\n"
+            "  --xor                                    Use XOR clauses (default: off)\n"
+          );
+}
+
+/* 'len' bits of the decimal string 't', least significant first */
+static vector<int> toBits(string t, int len)
 {
-#ifdef TEST1
-    LongMult f(5);
+    vector<int> x;
+    while( t.size() > 0 )
+    {
+        int r = 0;
+        for( size_t i=0; i<t.size(); i++ )
+        {
+            int d = r * 10 + t[i] - '0';
+            r = d % 2;
+            t[i] = d / 2 + '0';
+        }
+        x.push_back(r);
+        while( t.size() > 0 && t[0] == '0' )
+            t.erase(0, 1);
+    }
+    x.resize(len, 0);
+    return x;
+}
+
+int main(int argc, char **argv)
+{
+    /* Arguments default values */
+    cfg_problem = PT_PPA;
+    cfg_bits = 8;
+    cfg_target = "171";
+    cfg_use_xor_clauses = 0;
+    cfg_tree = Formula::TT_NONE;
+    cfg_adder = Formula::AT_NONE;
+
+    struct option long_options[] =
+    {
+        /* flag options */
+        {"xor",     no_argument, &cfg_use_xor_clauses, 1},
+        /* valued options */
+        {"problem", required_argument, 0, 'p'},
+        {"bits",    required_argument, 0, 'n'},
+        {"target",  required_argument, 0, 't'},
+        {"tree",    required_argument, 0, 'T'},
+        {"carry",   required_argument, 0, 'C'},
+        {"help",    no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "p:n:t:T:C:h", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 0:
+                break;
+
+            case 'p':
+                cfg_problem = strcmp(optarg, "long") == 0 ? PT_LONG :
+                    strcmp(optarg, "mod") == 0 ? PT_MOD :
+                    strcmp(optarg, "ppa") == 0 ? PT_PPA :
+                    PT_NONE;
+                if ( cfg_problem == PT_NONE )
+                {
+                    fprintf(stderr, "Invalid or missing problem type!\nUse -p or --problem\n");
+                    return 1;
+                }
+                break;
+
+            case 'n':
+                cfg_bits = atoi(optarg);
+                break;
+
+            case 't':
+                cfg_target = optarg;
+                break;
+
+            case 'T':
+                cfg_tree =
+                    strcmp(optarg, "array") == 0 ? Formula::TT_NONE :
+                    strcmp(optarg, "wallace") == 0 ? Formula::WALLACE :
+                    strcmp(optarg, "dadda") == 0 ? Formula::DADDA :
+                    strcmp(optarg, "compressor42") == 0 ? Formula::COMPRESSOR_42 :
+                    (Formula::TreeType)-1;
+                if ( cfg_tree == (Formula::TreeType)-1 )
+                {
+                    fprintf(stderr, "Invalid or missing tree type!\nUse -h to see the options\n");
+                    return 1;
+                }
+                break;
+
+            case 'C':
+                cfg_adder =
+                    strcmp(optarg, "ripple") == 0 ? Formula::RIPPLE_CARRY :
+                    strcmp(optarg, "kogge_stone") == 0 ? Formula::KOGGE_STONE :
+                    strcmp(optarg, "brent_kung") == 0 ? Formula::BRENT_KUNG :
+                    Formula::AT_NONE;
+                if ( cfg_adder == Formula::AT_NONE )
+                {
+                    fprintf(stderr, "Invalid or missing carry type!\nUse -h to see the options\n");
+                    return 1;
+                }
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
 
-//    int z[10] = {1, 0, 1, 1, 1, 1, 1, 1, 0, 0};
-//    f.fixOutput(z, 10);
+            default:
+                abort ();
+        }
+    }
 
-    f.fixOutput("253");
-    f.cnf.dimacs();
-#endif
+    if ( cfg_bits < 1 || cfg_bits > MAX_WIDTH )
+    {
+        fprintf(stderr, "Number of bits should be in 1..%d!\n", MAX_WIDTH);
+        return 1;
+    }
 
-#ifdef TEST2
-    ModMult f(3);
-    int z[3] = {1, 0, 0};
-    f.fixOutput(z, 3);
-    f.cnf.dimacs();
-#endif
+    if ( cfg_problem == PT_LONG )
+    {
+        LongMult f(cfg_bits, cfg_use_xor_clauses, cfg_tree,
+                cfg_adder == Formula::AT_NONE ? Formula::RIPPLE_CARRY : cfg_adder);
+        f.fixOutput(cfg_target);
+        f.cnf.dimacs();
+    }
+    else if ( cfg_problem == PT_MOD )
+    {
+        ModMult f(cfg_bits, 1, cfg_use_xor_clauses);
+        vector<int> z = toBits(cfg_target, cfg_bits);
+        f.fixOutput(z.data(), cfg_bits);
+        f.cnf.dimacs();
+    }
+    else
+    {
+        ParallelPrefixAdder ppa(cfg_bits, cfg_adder == Formula::AT_NONE ? Formula::KOGGE_STONE : cfg_adder);
+        if ( cfg_use_xor_clauses ) ppa.setUseXORClauses();
 
-#ifdef TEST3
-    ParallelPrefixAdder ppa(8);
+        ppa.newVars(ppa.X, cfg_bits);
+        ppa.newVars(ppa.Y, cfg_bits);
+        ppa.newVars(ppa.Z, cfg_bits);
 
-    ppa.newVars(ppa.X, 8);
-    ppa.newVars(ppa.Y, 8);
-    ppa.newVars(ppa.Z, 8);
+        vector<int> z = toBits(cfg_target, cfg_bits);
+        for( int i=0; i<cfg_bits; i++ )
+            ppa.fixedValue(&ppa.Z[i], z[i], 1);
 
-    ppa.fixedValue(ppa.Z, 0xab, 8);
+        ppa.encode();
 
-    ppa.encode();
+        ppa.dimacs();
+    }
 
-    ppa.dimacs();
-#endif
     return 0;
 }
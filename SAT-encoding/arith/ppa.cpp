@@ -1,10 +1,11 @@
 #include "ppa.h"
 #include <stdio.h>
 
-ParallelPrefixAdder::ParallelPrefixAdder(int n)
+ParallelPrefixAdder::ParallelPrefixAdder(int n, AdderType type)
     : Formula("")
 {
     N = n;
+    setAdderType(type);
 }
 
 ParallelPrefixAdder::~ParallelPrefixAdder()
@@ -19,10 +20,15 @@ void ParallelPrefixAdder::encode()
         N == 8 ? 3 :
         N == 16 ? 4 :
         N == 32 ? 5 : -1;
-    if ( m == -1 ) { printf("For now only considering bitwidth of power of two up to 32\n"); exit(1); }
-    // TODO 1. Support a generic bit-width
-    //      2. Some p variables are not used (last layer and first column)
-    //      3. Add support for carry-in and carry-out
+
+    /* other widths and adder types go through Formula::prefixAdd */
+    if ( m == -1 || adderType != KOGGE_STONE )
+    {
+        prefixAdd(Z, X, Y, N);
+        return;
+    }
+    // TODO 1. Some p variables are not used (last layer and first column)
+    //      2. Add support for carry-in and carry-out
 
     int g[m+1][N], p[m+1][N];
 
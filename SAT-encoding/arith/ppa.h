@@ -7,7 +7,7 @@
 
 class ParallelPrefixAdder : public Formula {
     public:
-        ParallelPrefixAdder(int n = 32);
+        ParallelPrefixAdder(int n = 32, AdderType type = KOGGE_STONE);
         ~ParallelPrefixAdder();
 
         void encode();
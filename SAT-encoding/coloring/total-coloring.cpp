@@ -6,32 +6,51 @@
  *
  * I assume nodes are colored from 1 to n.
  *
+ * The optional second argument picks the encoding of "exactly one color per
+ * edge": pairwise (default) or one of the encodings of cardinality.h.
+ *
  */
 
+#include "cardinality.h"
 #include <stdio.h>
 #include <vector>
 #include <utility>
 #include <algorithm>
 #include <iostream>
+#include <string.h>
 
 using namespace std;
-typedef vector<int> Clause;
 typedef pair<int, int> Pair;
 
 int main(int argc, char **argv)
 {
     int n = atoi(argv[1]);
     int m = n * (n - 1) / 2, K = n + 1;
+
+    Cardinality::Encoding enc = Cardinality::CE_NONE;
+    if ( argc > 2 && strcmp(argv[2], "pairwise") != 0 )
+    {
+        enc = Cardinality::parse(argv[2]);
+        if ( enc == Cardinality::CE_NONE )
+        {
+            fprintf(stderr, "Invalid encoding! Use pairwise, sequential, totalizer, network or adder\n");
+            return 1;
+        }
+    }
+
     vector<Pair> edges;
-    vector<Clause> formula;
+
+    Formula cnf;
+    vector<int> colors(m * K);
+    cnf.newVars(colors.data(), m * K);
 
     /* Prevent same color on node-edge */
     for( int i=0,u=0; u<n; u++ )
         for( int v=u+1; v<n; v++,i++ )
         {
             edges.push_back( Pair(u, v) );
-            formula.push_back( {-(i * K + u + 1)} );
-            formula.push_back( {-(i * K + v + 1)} );
+            cnf.addClause( {-(i * K + u + 1)} );
+            cnf.addClause( {-(i * K + v + 1)} );
         }
 
     for( int i=0; i<m; i++ )
@@ -45,34 +64,37 @@ int main(int argc, char **argv)
                 for( int c=0; c<K; c++ )
                 {
                     /* prevent same color for edge-edge */
-                    formula.push_back( {-(i * K + c + 1), -(j * K + c + 1)} );
+                    cnf.addClause( {-(i * K + c + 1), -(j * K + c + 1)} );
                 }
             }
 
     for( int i=0; i<m; i++ )
     {
-        Clause edgeClause;
+        if ( enc != Cardinality::CE_NONE )
+        {
+            /* exactly one color on an edge */
+            Cardinality card(cnf, enc);
+            card.encode(&colors[i * K], K, 1);
+            card.exactly(1);
+            continue;
+        }
+
+        vector<int> edgeClause;
         for( int cx=0; cx<K; cx++ )
         {
             edgeClause.push_back( i * K + cx + 1 );
             for( int cy=cx+1; cy<K; cy++ )
             {
                 /* prevent multiple colors on an edge */
-                formula.push_back( {-(i * K + cx + 1), -(i * K + cy + 1)} );
+                cnf.addClause( {-(i * K + cx + 1), -(i * K + cy + 1)} );
             }
         }
         /* force each edge to get a color */
-        formula.push_back( edgeClause );
+        cnf.addClause( edgeClause );
     }
 
     /* Printing the SAT formula in dimacs format */
-    cout << "p cnf " << m * K << " " << formula.size() << endl;
-    for( auto clause : formula )
-    {
-        for( int var : clause )
-            cout << var << " ";
-        cout << "0" << endl;
-    }
+    cnf.dimacs();
 
     return 0;
 }
@@ -0,0 +1,266 @@
+#include "cardinality.h"
+#include <stdlib.h>
+#include <string.h>
+
+Cardinality::Cardinality(Formula &f, Encoding e) : cnf(f)
+{
+    encoding = e;
+    total = 0;
+    trueVar = 0;
+}
+
+Cardinality::Encoding Cardinality::parse(const char *name)
+{
+    return strcmp(name, "sequential") == 0 ? SEQUENTIAL_COUNTER :
+        strcmp(name, "totalizer") == 0 ? TOTALIZER :
+        strcmp(name, "network") == 0 ? CARDINALITY_NETWORK :
+        strcmp(name, "adder") == 0 ? ADDER :
+        CE_NONE;
+}
+
+void Cardinality::encode(const int *x, int n, int bound, const unsigned *w)
+{
+    if ( w && encoding != ADDER )
+    {
+        fprintf(stderr, "Weighted sums need the adder encoding!\n");
+        exit(1);
+    }
+
+    total = 0;
+    for( int i=0; i<n; i++ )
+        total += w ? w[i] : 1;
+
+    out.clear();
+    bits.clear();
+    upper.clear();
+    lower.clear();
+
+    /* out[j] is only needed for j <= bound */
+    int k = bound < 0 || bound >= n ? n : bound + 1;
+    if ( n == 0 )
+        return;
+    else if ( encoding == SEQUENTIAL_COUNTER )
+        sequential(x, n, k);
+    else if ( encoding == TOTALIZER )
+        out = totalizer(x, n, k);
+    else if ( encoding == CARDINALITY_NETWORK )
+        network(x, n, k);
+    else
+        adder(x, n, w);
+}
+
+int Cardinality::atMost(int k)
+{
+    if ( k >= total ) return lit(TRUE_LIT);
+    if ( k < 0 ) return lit(-TRUE_LIT);
+    if ( encoding == ADDER ) return compare(k, true);
+    if ( k >= (int)out.size() )
+    {
+        fprintf(stderr, "Bound %d is above the bound the counter was built for (%d)!\n", k, (int)out.size() - 1);
+        exit(1);
+    }
+    return -out[k];
+}
+
+int Cardinality::atLeast(int k)
+{
+    if ( k <= 0 ) return lit(TRUE_LIT);
+    if ( k > total ) return lit(-TRUE_LIT);
+    if ( encoding == ADDER ) return compare(k, false);
+    if ( k > (int)out.size() )
+    {
+        fprintf(stderr, "Bound %d is above the bound the counter was built for (%d)!\n", k, (int)out.size() - 1);
+        exit(1);
+    }
+    return out[k-1];
+}
+
+void Cardinality::exactly(int k)
+{
+    cnf.addClause({atMost(k)});
+    cnf.addClause({atLeast(k)});
+}
+
+int Cardinality::lit(int l)
+{
+    if ( abs(l) != TRUE_LIT ) return l;
+    if ( !trueVar )
+    {
+        cnf.newVars(&trueVar, 1);
+        cnf.fixedValue(&trueVar, 1, 1);
+    }
+    return l > 0 ? trueVar : -trueVar;
+}
+
+void Cardinality::clause(initializer_list<int> c)
+{
+    vector<int> cl;
+    for( int l : c )
+    {
+        if ( l == TRUE_LIT ) return;
+        if ( l != -TRUE_LIT ) cl.push_back(l);
+    }
+    cnf.addClause(cl);
+}
+
+/* s[j] of input i: x[0] + ... + x[i] >= j+1, from s of input i-1 (a) */
+void Cardinality::sequential(const int *x, int n, int k)
+{
+    vector<int> a(k, -TRUE_LIT), s(k);
+    for( int i=0; i<n; i++ )
+    {
+        for( int j=0; j<k; j++ )
+        {
+            if ( j > i ) { s[j] = -TRUE_LIT; continue; }
+
+            int b = j ? a[j-1] : TRUE_LIT;
+            cnf.newVars(&s[j], 1);
+            clause({-a[j], s[j]});
+            clause({-x[i], -b, s[j]});
+            clause({-s[j], a[j], x[i]});
+            clause({-s[j], a[j], b});
+        }
+        a.swap(s);
+    }
+
+    out.resize(k);
+    for( int j=0; j<k; j++ )
+        out[j] = lit(a[j]);
+}
+
+/* unary sum of x[0..n-1], truncated to 'k' outputs */
+vector<int> Cardinality::totalizer(const int *x, int n, int k)
+{
+    if ( n == 1 ) return vector<int>(1, x[0]);
+
+    vector<int> a = totalizer(x, n/2, k);
+    vector<int> b = totalizer(x + n/2, n - n/2, k);
+    int p = a.size(), q = b.size();
+    vector<int> r(min(p + q, k));
+    cnf.newVars(r.data(), r.size());
+
+    /* a[i-1] is "at least i" of the left half; 'at least 0' is true, 'at least p+1' false */
+    auto A = [&](int i) { return i == 0 ? TRUE_LIT : i > p ? -TRUE_LIT : a[i-1]; };
+    auto B = [&](int j) { return j == 0 ? TRUE_LIT : j > q ? -TRUE_LIT : b[j-1]; };
+    for( int i=0; i<=p; i++ )
+        for( int j=0; j<=q; j++ )
+        {
+            if ( i + j > 0 )
+                clause({-A(i), -B(j), r[min(i + j, (int)r.size()) - 1]});
+            if ( i + j < (int)r.size() )
+                clause({A(i + 1), B(j + 1), -r[i + j]});
+        }
+
+    return r;
+}
+
+void Cardinality::network(const int *x, int n, int k)
+{
+    int N = 1;
+    while( N < n ) N *= 2;
+
+    /* Batcher's odd-even merge sort, larger values to lower wires */
+    vector<pair<int, int>> cmp;
+    for( int p=1; p<N; p*=2 )
+        for( int d=p; d>=1; d/=2 )
+            for( int j=d%p; j+d<N; j+=2*d )
+                for( int i=0; i<min(d, N-j-d); i++ )
+                    if ( (i + j) / (2 * p) == (i + j + d) / (2 * p) )
+                        cmp.push_back(make_pair(i + j, i + j + d));
+
+    /* Only the comparator outputs that reach out[0..k-1] are encoded */
+    vector<char> need(N, 0);
+    vector<pair<char, char>> used(cmp.size());
+    fill(need.begin(), need.begin() + k, 1);
+    for( int c=cmp.size()-1; c>=0; c-- )
+    {
+        int i = cmp[c].first, j = cmp[c].second;
+        used[c] = make_pair(need[i], need[j]);
+        if ( need[i] || need[j] ) need[i] = need[j] = 1;
+    }
+
+    vector<int> wire(N, -TRUE_LIT);
+    copy(x, x + n, wire.begin());
+    for( size_t c=0; c<cmp.size(); c++ )
+    {
+        int &a = wire[cmp[c].first], &b = wire[cmp[c].second];
+        int hi = 0, lo = 0;
+
+        /* constants pass through a comparator */
+        if ( a == TRUE_LIT || b == -TRUE_LIT ) { hi = a; lo = b; }
+        else if ( a == -TRUE_LIT || b == TRUE_LIT ) { hi = b; lo = a; }
+        else
+        {
+            if ( used[c].first ) { cnf.newVars(&hi, 1); cnf.or2(&hi, &a, &b, 1); }
+            if ( used[c].second ) { cnf.newVars(&lo, 1); cnf.and2(&lo, &a, &b, 1); }
+        }
+        a = hi;
+        b = lo;
+    }
+
+    out.resize(k);
+    for( int j=0; j<k; j++ )
+        out[j] = lit(wire[j]);
+}
+
+void Cardinality::adder(const int *x, int n, const unsigned *w)
+{
+    int size = 1;
+    while( (1L << size) <= total ) size++;
+
+    /* a weighted input is an addend of every column of a set bit of its weight */
+    vector<queue<int>> m(size);
+    for( int i=0; i<n; i++ )
+        for( int b=0; b<size; b++ )
+            if ( ((w ? w[i] : 1) >> b) & 1 )
+                m[b].push(x[i]);
+
+    for( int i=0; i<size; i++ )
+    {
+        while( m[i].size() >= 2 )
+        {
+            int x0 = m[i].front(); m[i].pop();
+            int x1 = m[i].front(); m[i].pop();
+            int s, c;
+            cnf.newVars(&s, 1);
+            cnf.newVars(&c, 1);
+            if ( m[i].size() >= 1 )
+            {
+                int x2 = m[i].front(); m[i].pop();
+                cnf.fulladder(&c, &s, &x0, &x1, &x2, 1);
+            }
+            else
+                cnf.halfadder(&c, &s, &x0, &x1, 1);
+            m[i].push(s);
+            if ( i+1 < size ) m[i+1].push(c);
+        }
+        bits.push_back(m[i].empty() ? lit(-TRUE_LIT) : m[i].front());
+    }
+}
+
+/*
+ * Literal implying sum <= k (le) or sum >= k (!le). The sum breaks the bound iff at
+ * some bit it differs from 'k' in the wrong direction and agrees with it above:
+ * one clause per such bit, no new variables besides the literal itself.
+ */
+int Cardinality::compare(int k, bool le)
+{
+    map<int, int> &cache = le ? upper : lower;
+    if ( cache.count(k) ) return cache[k];
+
+    int l;
+    cnf.newVars(&l, 1);
+    int size = bits.size();
+    for( int i=0; i<size; i++ )
+    {
+        bool ki = (k >> i) & 1;
+        if ( ki == le ) continue;
+
+        vector<int> c = { -l, le ? -bits[i] : bits[i] };
+        for( int j=i+1; j<size; j++ )
+            c.push_back((k >> j) & 1 ? -bits[j] : bits[j]);
+        cnf.addClause(c);
+    }
+
+    return cache[k] = l;
+}
@@ -0,0 +1,59 @@
+#ifndef _CARDINALITY_H_
+#define _CARDINALITY_H_
+
+#include "formula.h"
+
+/*
+ * Encodings of x[0] + ... + x[n-1] (or, with ADDER, of w[0]*x[0] + ... + w[n-1]*x[n-1])
+ * into the clauses of a Formula.
+ *
+ * encode() builds the counter once; atMost()/atLeast() then return a literal that
+ * implies the bound, so the same counter serves many bounds: add the literal as a
+ * unit clause, or pass it as an assumption to tighten a bound incrementally.
+ * The unary encodings (everything but ADDER) only count up to 'bound' + 1, which
+ * keeps them small for small bounds; asking for a larger bound is an error.
+ */
+class Cardinality
+{
+    public:
+        enum Encoding {
+            SEQUENTIAL_COUNTER,       // Sinz' sequential counter, O(n * bound) clauses
+            TOTALIZER,                // Bailleux-Boufkhad totalizer, a tree of unary adders
+            CARDINALITY_NETWORK,      // Batcher's odd-even merge sort, only the comparators reaching the first 'bound' + 1 outputs
+            ADDER,                    // Binary sum (full/half adder tree) and a comparator per bound, O(n) clauses; supports weights
+            CE_NONE,
+        };
+
+        Cardinality(Formula &f, Encoding e = TOTALIZER);
+
+        void encode(const int *x, int n, int bound = -1, const unsigned *w = NULL); // 'bound' defaults to n (no truncation)
+
+        int atMost(int k);                                                      // Literal implying sum <= k
+        int atLeast(int k);                                                     // Literal implying sum >= k
+        void exactly(int k);                                                    // Adds sum == k as unit clauses
+
+        static Encoding parse(const char *name);                                // "sequential" | "totalizer" | "network" | "adder", CE_NONE otherwise
+
+        vector<int> out;                                                        // unary encodings: out[j] <-> sum >= j+1
+        vector<int> bits;                                                       // ADDER: binary sum, least significant bit first
+
+    protected:
+        static const int TRUE_LIT = 0x7fffffff;                                 // constant inputs/outputs, -TRUE_LIT is false
+
+        Formula &cnf;
+        Encoding encoding;
+        int total;                                                              // largest possible sum
+        int trueVar;
+        map<int, int> upper, lower;                                             // ADDER comparators by bound
+
+        int lit(int l);                                                         // Replaces the constants by a variable fixed to true
+        void clause(initializer_list<int> c);                                   // Adds 'c' without false constants, unless it has a true one
+
+        void sequential(const int *x, int n, int k);
+        vector<int> totalizer(const int *x, int n, int k);
+        void network(const int *x, int n, int k);
+        void adder(const int *x, int n, const unsigned *w);
+        int compare(int k, bool le);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _CMSAT_H_
+#define _CMSAT_H_
+
+#include "formula.h"
+#include <cryptominisat4/cryptominisat.h>
+
+/*
+ * Adds the clauses of a Formula to a cryptominisat solver through its library
+ * API (add_clause/add_xor_clause) instead of DIMACS text. Only the programs
+ * including this header need to be linked with -lcryptominisat4.
+ *
+ * The clauses kept so far and every clause added to 'f' afterwards go to 's'
+ * (see Formula::stream), so 's' has to outlive the encoding. Variable 'v' of
+ * the formula is variable 'v-1' of the solver. An XOR clause 'x l1 ... lk 0'
+ * means l1 ^ ... ^ lk, the same as in cryptominisat's DIMACS parser.
+ */
+inline void addToSolver(Formula &f, CMSat::SATSolver &s)
+{
+    vector<CMSat::Lit> cl;
+    vector<unsigned> vars;
+    f.stream([&s, cl, vars](const int *c, int n, bool xorC) mutable
+    {
+        unsigned maxVar = 0;
+        for( int i=0; i<n; i++ )
+            maxVar = max(maxVar, (unsigned)abs(c[i]));
+        if ( maxVar > s.nVars() )
+            s.new_vars(maxVar - s.nVars());
+
+        if ( xorC )
+        {
+            bool rhs = true;
+            vars.clear();
+            for( int i=0; i<n; i++ )
+            {
+                vars.push_back(abs(c[i]) - 1);
+                if ( c[i] < 0 ) rhs = !rhs;
+            }
+            s.add_xor_clause(vars, rhs);
+            return;
+        }
+
+        cl.clear();
+        for( int i=0; i<n; i++ )
+            cl.push_back(CMSat::Lit(abs(c[i]) - 1, c[i] < 0));
+        s.add_clause(cl);
+    });
+}
+
+/* Value of variable 'v' (1-based) in the model of 's' */
+inline bool modelValue(const CMSat::SATSolver &s, int v)
+{
+    return s.get_model()[v - 1] == CMSat::l_True;
+}
+
+#endif
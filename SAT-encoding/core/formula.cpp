@@ -3,7 +3,16 @@
 #include <math.h>
 #include <assert.h>
 #include <string.h>
-#include <sys/wait.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <mutex>
+#include <thread>
+
+/* width of the placeholder header of a streamed formula, large enough for any two ints */
+#define HEADER_LEN 32
+
+/* variables of sub-formulas are numbered from here until they are merged */
+#define SUB_BASE (1 << 30)
 
 Formula::Formula(string name)
 {
@@ -13,15 +22,32 @@ Formula::Formula(string name)
     useFACardinality = false;
     adderType = RIPPLE_CARRY;
     multiAdderType = ESPRESSO;
+    treeType = WALLACE;
     formulaName = name;
+
+    sink = NULL;
+    spill = NULL;
+    headerPos = -1;
+    bufLen = 0;
+    streamedCnt = 0;
+    subBase = 0;
+    parent = NULL;
+    structuralHashing = false;
 }
 
 Formula::~Formula()
 {
+    if ( spill ) fclose(spill);
 }
 
 void Formula::newVars(int *x, int n, string name)
 {
+    if ( !subBase && varID + n >= SUB_BASE )
+    {
+        fprintf(stderr, "Too many variables!\n");
+        exit(1);
+    }
+
 	for ( int i=0; i<n; i++ )
 		x[i] = ++varID;
 
@@ -29,28 +55,29 @@ void Formula::newVars(int *x, int n, string name)
     varCnt += n;
 }
 
-void Formula::addClause(vector<int> v)
+void Formula::addClause(const int *c, int n, bool xorC)
 {
-    if ( any_of(v.begin(), v.end(), [](int x){ return x==0; }) )
+    for( int i=0; i<n; i++ )
     {
-        fprintf(stderr, "bad vector clause:");
-        for( int x : v ) fprintf(stderr, " %d", x);
+        if ( c[i] != 0 ) continue;
+        fprintf(stderr, "bad clause:");
+        for( int j=0; j<n; j++ ) fprintf(stderr, " %d", c[j]);
         fprintf(stderr, "\n");
         exit(1);
     }
-    clauses.push_back(Clause(v));
-}
 
-void Formula::addClause(Clause c)
-{
-    if ( any_of(c.lits.begin(), c.lits.end(), [](int x){ return x==0; }) )
+    if ( sink || handler )
     {
-        fprintf(stderr, "bad clause:");
-        for( int x : c.lits ) fprintf(stderr, " %d", x);
-        fprintf(stderr, "\n");
-        exit(1);
+        writeClause(c, n, xorC);
+        return;
     }
-    clauses.push_back(c);
+
+    ClauseRef r;
+    r.offset = lits.size();
+    r.size = n;
+    r.xor_clause = xorC;
+    lits.insert(lits.end(), c, c + n);
+    clauses.push_back(r);
 }
 
 void Formula::fixedValue(int *z, unsigned value, int n)
@@ -58,7 +85,10 @@ void Formula::fixedValue(int *z, unsigned value, int n)
     for( int i=0; i<n; i++ )
     {
         int x = (value >> i) & 1 ? z[i] : -z[i];
-        addClause({x});
+        if ( structuralHashing )
+            setValue(x, true);
+        else
+            addClause({x});
     }
 }
 
@@ -78,6 +108,12 @@ void Formula::and2(int *z, int *x, int *y, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            andGate(z[i], x[i], y[i]);
+            continue;
+        }
+
         addClause( {z[i], -x[i], -y[i]} );
         addClause( {-z[i], x[i]} );
         addClause( {-z[i], y[i]} );
@@ -88,6 +124,12 @@ void Formula::or2(int *z, int *x, int *y, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            andGate(-z[i], -x[i], -y[i]);
+            continue;
+        }
+
         addClause( {-z[i], x[i], y[i]} );
         addClause( {z[i], -x[i]} );
         addClause( {z[i], -y[i]} );
@@ -98,6 +140,12 @@ void Formula::eq(int *z, int *x, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            equiv(z[i], x[i]);
+            continue;
+        }
+
         addClause( {-z[i], x[i]} );
         addClause( {z[i], -x[i]} );
     }
@@ -107,6 +155,12 @@ void Formula::neq(int *z, int *x, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            equiv(z[i], -x[i]);
+            continue;
+        }
+
         addClause( {z[i], x[i]} );
         addClause( {-z[i], -x[i]} );
     }
@@ -116,9 +170,15 @@ void Formula::xor2(int *z, int *x, int *y, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            xorGate(z[i], x[i], y[i]);
+            continue;
+        }
+
         if ( useXORClauses )
         {
-            addClause( Clause({-z[i], x[i], y[i]}, true) );
+            addClause( {-z[i], x[i], y[i]}, true );
         }
         else
         {
@@ -134,9 +194,15 @@ void Formula::xor3(int *z, int *x, int *y, int *t, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            xor3Gate(z[i], x[i], y[i], t[i]);
+            continue;
+        }
+
         if ( useXORClauses )
         {
-            addClause( Clause({-z[i], x[i], y[i], t[i]}, true) );
+            addClause( {-z[i], x[i], y[i], t[i]}, true );
         }
         else
         {
@@ -158,7 +224,7 @@ void Formula::xor4(int *z, int *a, int *b, int *c, int *d, int n)
     {
         if ( useXORClauses )
         {
-            addClause( Clause({-z[i], a[i], b[i], c[i], d[i]}, true) );
+            addClause( {-z[i], a[i], b[i], c[i], d[i]}, true );
         }
         else
         {
@@ -186,6 +252,12 @@ void Formula::ch(int *z, int *x, int *y, int *t, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            chGate(z[i], x[i], y[i], t[i]);
+            continue;
+        }
+
         addClause( {-z[i], x[i], t[i]} );
         addClause( {-z[i], -x[i], y[i]} );
         addClause( {z[i], x[i], -t[i]} );
@@ -197,6 +269,12 @@ void Formula::maj3(int *z, int *x, int *y, int *t, int n)
 {
     for( int i=0; i<n; i++ )
     {
+        if ( structuralHashing )
+        {
+            majGate(z[i], x[i], y[i], t[i]);
+            continue;
+        }
+
         addClause( {-z[i], x[i], y[i]} );
         addClause( {-z[i], x[i], t[i]} );
         addClause( {-z[i], y[i], t[i]} );
@@ -206,6 +284,183 @@ void Formula::maj3(int *z, int *x, int *y, int *t, int n)
     }
 }
 
+int Formula::value(int l) const
+{
+    for( const Formula *f = this; f; f = f->parent )
+    {
+        auto it = f->constant.find(abs(l));
+        if ( it != f->constant.end() )
+            return it->second == (l > 0) ? 1 : -1;
+    }
+    return 0;
+}
+
+void Formula::setValue(int l, bool v)
+{
+    addClause({ v ? l : -l });
+    constant[abs(l)] = (l > 0) == v;
+}
+
+int Formula::findGate(const GateKey &k) const
+{
+    for( const Formula *f = this; f; f = f->parent )
+    {
+        auto it = f->gates.find(k);
+        if ( it != f->gates.end() )
+            return it->second;
+    }
+    return 0;
+}
+
+void Formula::equiv(int z, int l)
+{
+    int v = value(l);
+    if ( v != 0 )
+        setValue(z, v > 0);
+    else if ( z != l )
+    {
+        addClause( {-z, l} );
+        addClause( {z, -l} );
+    }
+}
+
+void Formula::andGate(int z, int x, int y)
+{
+    int vx = value(x), vy = value(y);
+    if ( vx < 0 || vy < 0 || x == -y ) { setValue(z, false); return; }
+    if ( vx > 0 ) { equiv(z, y); return; }
+    if ( vy > 0 || x == y ) { equiv(z, x); return; }
+
+    GateKey k = {{ G_AND, min(x, y), max(x, y), 0 }};
+    int g = findGate(k);
+    if ( g ) { equiv(z, g); return; }
+    gates[k] = z;
+
+    addClause( {z, -x, -y} );
+    addClause( {-z, x} );
+    addClause( {-z, y} );
+}
+
+void Formula::xorGate(int z, int x, int y)
+{
+    int vx = value(x), vy = value(y);
+    if ( vx != 0 ) { equiv(z, vx > 0 ? -y : y); return; }
+    if ( vy != 0 ) { equiv(z, vy > 0 ? -x : x); return; }
+    if ( x == y || x == -y ) { setValue(z, x == -y); return; }
+
+    /* on variables; the negations only flip the output */
+    if ( (x < 0) != (y < 0) ) z = -z;
+    x = abs(x);
+    y = abs(y);
+    GateKey k = {{ G_XOR, min(x, y), max(x, y), 0 }};
+    int g = findGate(k);
+    if ( g ) { equiv(z, g); return; }
+    gates[k] = z;
+
+    if ( useXORClauses )
+    {
+        addClause( {-z, x, y}, true );
+    }
+    else
+    {
+        addClause( {-z, -x, -y} );
+        addClause( { z, -x,  y} );
+        addClause( { z,  x, -y} );
+        addClause( {-z,  x,  y} );
+    }
+}
+
+void Formula::xor3Gate(int z, int x, int y, int t)
+{
+    int v[3] = { value(x), value(y), value(t) };
+    if ( v[0] != 0 ) { xorGate(v[0] > 0 ? -z : z, y, t); return; }
+    if ( v[1] != 0 ) { xorGate(v[1] > 0 ? -z : z, x, t); return; }
+    if ( v[2] != 0 ) { xorGate(v[2] > 0 ? -z : z, x, y); return; }
+    if ( x == y || x == -y ) { equiv(z, x == y ? t : -t); return; }
+    if ( x == t || x == -t ) { equiv(z, x == t ? y : -y); return; }
+    if ( y == t || y == -t ) { equiv(z, y == t ? x : -x); return; }
+
+    if ( ((x < 0) != (y < 0)) != (t < 0) ) z = -z;
+    int in[3] = { abs(x), abs(y), abs(t) };
+    sort(in, in + 3);
+    x = in[0];
+    y = in[1];
+    t = in[2];
+    GateKey k = {{ G_XOR3, x, y, t }};
+    int g = findGate(k);
+    if ( g ) { equiv(z, g); return; }
+    gates[k] = z;
+
+    if ( useXORClauses )
+    {
+        addClause( {-z, x, y, t}, true );
+    }
+    else
+    {
+        addClause( { z, -x, -y, -t} );
+        addClause( {-z, -x, -y,  t} );
+        addClause( {-z, -x,  y, -t} );
+        addClause( { z, -x,  y,  t} );
+        addClause( {-z,  x, -y, -t} );
+        addClause( { z,  x, -y,  t} );
+        addClause( { z,  x,  y, -t} );
+        addClause( {-z,  x,  y,  t} );
+    }
+}
+
+void Formula::majGate(int z, int x, int y, int t)
+{
+    int v[3] = { value(x), value(y), value(t) };
+    if ( v[0] != 0 ) { v[0] > 0 ? andGate(-z, -y, -t) : andGate(z, y, t); return; }
+    if ( v[1] != 0 ) { v[1] > 0 ? andGate(-z, -x, -t) : andGate(z, x, t); return; }
+    if ( v[2] != 0 ) { v[2] > 0 ? andGate(-z, -x, -y) : andGate(z, x, y); return; }
+    if ( x == y || x == -y ) { equiv(z, x == y ? x : t); return; }
+    if ( x == t || x == -t ) { equiv(z, x == t ? x : y); return; }
+    if ( y == t || y == -t ) { equiv(z, y == t ? y : x); return; }
+
+    int in[3] = { x, y, t };
+    sort(in, in + 3);
+    x = in[0];
+    y = in[1];
+    t = in[2];
+    GateKey k = {{ G_MAJ, x, y, t }};
+    int g = findGate(k);
+    if ( g ) { equiv(z, g); return; }
+    gates[k] = z;
+
+    addClause( {-z, x, y} );
+    addClause( {-z, x, t} );
+    addClause( {-z, y, t} );
+    addClause( {z, -y, -t} );
+    addClause( {z, -x, -t} );
+    addClause( {z, -x, -y} );
+}
+
+void Formula::chGate(int z, int x, int y, int t)
+{
+    if ( x < 0 ) { chGate(z, -x, t, y); return; }                               // !x ? y : t == x ? t : y
+
+    int vx = value(x), vy = value(y), vt = value(t);
+    if ( vx != 0 ) { equiv(z, vx > 0 ? y : t); return; }
+    if ( y == t ) { equiv(z, y); return; }
+    if ( vy != 0 ) { vy > 0 ? andGate(-z, -x, -t) : andGate(z, -x, t); return; }
+    if ( vt != 0 ) { vt > 0 ? andGate(-z, x, -y) : andGate(z, x, y); return; }
+    if ( x == y ) { andGate(-z, -x, -t); return; }                              // x | t
+    if ( x == -t ) { andGate(-z, x, -y); return; }                              // !x | y
+    if ( x == -y ) { andGate(z, -x, t); return; }
+    if ( x == t ) { andGate(z, x, y); return; }
+
+    GateKey k = {{ G_CH, x, y, t }};
+    int g = findGate(k);
+    if ( g ) { equiv(z, g); return; }
+    gates[k] = z;
+
+    addClause( {-z, x, t} );
+    addClause( {-z, -x, y} );
+    addClause( {z, x, -t} );
+    addClause( {z, -x, -y} );
+}
+
 void Formula::halfadder(int *c, int *s, int *x, int *y, int n)
 {
     xor2(s, x, y, n);
@@ -269,7 +524,9 @@ void Formula::counter(int *z, int *x, int n)
 
 void Formula::add2(int *z, int *x, int *y, int n)
 {
-    if ( multiAdderType == TWO_OPERAND || multiAdderType == DOT_MATRIX )
+    if ( (multiAdderType == TWO_OPERAND || multiAdderType == DOT_MATRIX) && adderType != RIPPLE_CARRY )
+        prefixAdd(z, x, y, n);
+    else if ( multiAdderType == TWO_OPERAND || multiAdderType == DOT_MATRIX )
     {
         int c[n-1];
         newVars(c, n-1);
@@ -513,125 +770,495 @@ void Formula::add5(int *z, int *a, int *b, int *c, int *d, int *e, int n)
     }
 }
 
-void Formula::espresso(const vector<int> &lhs, const vector<int> &rhs)
+void Formula::prefixAdd(int *z, int *x, int *y, int n)
 {
-    static map<pair<unsigned int, unsigned int>, vector<vector<int>>> cache;
+    if ( n == 1 )
+    {
+        xor2(z, x, y, 1);
+        return;
+    }
 
-    unsigned int n = lhs.size();
-    unsigned int m = rhs.size();
+    if ( adderType != KOGGE_STONE && adderType != BRENT_KUNG )
+    {
+        int c[n-1];
+        newVars(c, n-1);
+        halfadder(c, z, x, y, 1);
+        fulladder(c+1, z+1, x+1, y+1, c, n-2);
+        xor3(z+n-1, x+n-1, y+n-1, c+n-2, 1);
+        return;
+    }
 
-    vector<vector<int>> _clauses;
-    auto it = cache.find(make_pair(n, m));
-    if (it != cache.end())
+    /* bit generate/propagate; p[i] = x[i] ^ y[i] is also the sum bit without carry */
+    int g[n], p[n], t[n];
+    newVars(g, n);
+    newVars(t+1, n-1);
+    halfadder(g, z, x, y, 1);
+    halfadder(g+1, t+1, x+1, y+1, n-1);
+    p[0] = z[0];
+    for( int i=1; i<n; i++ )
+        p[i] = t[i];
+
+    /* g[i] becomes the carry out of bit i; the one of the top bit is not needed */
+    if ( adderType == KOGGE_STONE )
     {
-        _clauses = it->second;
+        for( int d=1; d<n; d*=2 )
+            for( int i=n-2; i>=d; i-- )
+                prefixCell(g[i], p[i], g[i-d], p[i-d], 2*d < n);
     }
     else
     {
-        int wfd[2], rfd[2];
+        int d;
+        for( d=1; d<n; d*=2 )
+            for( int i=2*d-1; i<n-1; i+=2*d )
+                prefixCell(g[i], p[i], g[i-d], p[i-d], true);
+        for( d/=4; d>=1; d/=2 )
+            for( int i=3*d-1; i<n-1; i+=2*d )
+                prefixCell(g[i], p[i], g[i-d], p[i-d], true);
+    }
 
-        /* pipe(): fd[0] is for reading, fd[1] is for writing */
+    xor2(z+1, t+1, g, n-1);
+}
 
-        if (pipe(wfd) == -1)
-            throw std::runtime_error("pipe() failed");
+void Formula::prefixCell(int &g, int &p, int gl, int pl, bool needP)
+{
+    int go;
+    newVars(&go, 1);
+    addClause({-go, g, gl});
+    addClause({-go, g, p});
+    addClause({go, -g});
+    addClause({go, -gl, -p});
+
+    if ( needP )
+    {
+        int po;
+        newVars(&po, 1);
+        and2(&po, &p, &pl, 1);
+        p = po;
+    }
+    g = go;
+}
 
-        if (pipe(rfd) == -1)
-            throw std::runtime_error("pipe() failed");
+void Formula::addColumns(int *z, vector<vector<int>> cols)
+{
+    int w = cols.size();
+    auto height = [&]()
+    {
+        size_t h = 0;
+        for( auto &c : cols ) h = max(h, c.size());
+        return (int)h;
+    };
+
+    /* adders of a stage; carries out of the top column are dropped (z is mod 2^w) */
+    vector<vector<int>> next;
+    auto fa = [&](int i, int a, int b, int c)
+    {
+        int sum, carry;
+        newVars(&sum, 1);
+        xor3(&sum, &a, &b, &c, 1);
+        next[i].push_back(sum);
+        if ( i+1 == w ) return;
+        newVars(&carry, 1);
+        maj3(&carry, &a, &b, &c, 1);
+        next[i+1].push_back(carry);
+    };
+    auto ha = [&](int i, int a, int b)
+    {
+        int sum, carry;
+        newVars(&sum, 1);
+        xor2(&sum, &a, &b, 1);
+        next[i].push_back(sum);
+        if ( i+1 == w ) return;
+        newVars(&carry, 1);
+        and2(&carry, &a, &b, 1);
+        next[i+1].push_back(carry);
+    };
+
+    /* Dadda heights: 2, 3, 4, 6, 9, 13, ... */
+    vector<int> dadda(1, 2);
+    while( dadda.back() < height() )
+        dadda.push_back(dadda.back() * 3 / 2);
+
+    while( height() > 2 )
+    {
+        next.assign(w, vector<int>());
+        if ( treeType == DADDA )
+        {
+            /* reduce every column (with the carries it gets in this stage) to the next height */
+            int d = *(lower_bound(dadda.begin(), dadda.end(), height()) - 1);
+            for( int i=0; i<w; i++ )
+            {
+                vector<int> &b = cols[i];
+                size_t k = 0;
+                int h = b.size() + next[i].size();
+                while( h > d && b.size() - k >= 2 )
+                {
+                    if ( h == d + 1 || b.size() - k == 2 ) { ha(i, b[k], b[k+1]); k += 2; h -= 1; }
+                    else { fa(i, b[k], b[k+1], b[k+2]); k += 3; h -= 2; }
+                }
+                next[i].insert(next[i].end(), b.begin() + k, b.end());
+            }
+        }
+        else if ( treeType == COMPRESSOR_42 )
+        {
+            vector<int> carryIn, carryOut;
+            for( int i=0; i<w; i++ )
+            {
+                vector<int> &b = cols[i];
+                size_t k = 0, c = 0;
+                carryOut.clear();
+                for( ; b.size() - k >= 4; k += 4 )
+                {
+                    int s, co;
+                    newVars(&s, 1);
+                    xor3(&s, &b[k], &b[k+1], &b[k+2], 1);
+                    if ( i+1 < w )
+                    {
+                        newVars(&co, 1);
+                        maj3(&co, &b[k], &b[k+1], &b[k+2], 1);
+                        carryOut.push_back(co);
+                    }
+                    if ( c < carryIn.size() ) fa(i, s, b[k+3], carryIn[c++]);
+                    else ha(i, s, b[k+3]);
+                }
+
+                vector<int> rest(b.begin() + k, b.end());
+                rest.insert(rest.end(), carryIn.begin() + c, carryIn.end());
+                size_t r = 0;
+                if ( rest.size() >= 3 ) { fa(i, rest[0], rest[1], rest[2]); r = 3; }
+                next[i].insert(next[i].end(), rest.begin() + r, rest.end());
+                carryIn.swap(carryOut);
+            }
+        }
+        else
+        {
+            for( int i=0; i<w; i++ )
+            {
+                vector<int> &b = cols[i];
+                size_t k = 0;
+                for( ; b.size() - k >= 3; k += 3 )
+                    fa(i, b[k], b[k+1], b[k+2]);
+                if ( b.size() - k == 2 ) { ha(i, b[k], b[k+1]); k += 2; }
+                next[i].insert(next[i].end(), b.begin() + k, b.end());
+            }
+        }
+        cols.swap(next);
+    }
 
-        pid_t child = fork();
-        if (child == 0)
+    /* two rows left, missing bits are a constant zero */
+    int zero = 0;
+    vector<int> a(w), b(w);
+    for( int i=0; i<w; i++ )
+    {
+        if ( cols[i].size() < 2 && !zero )
         {
-            if (dup2(wfd[0], STDIN_FILENO) == -1)
-                throw std::runtime_error("dup() failed");
+            newVars(&zero, 1);
+            fixedValue(&zero, 0, 1);
+        }
+        a[i] = cols[i].size() > 0 ? cols[i][0] : zero;
+        b[i] = cols[i].size() > 1 ? cols[i][1] : zero;
+    }
+    prefixAdd(z, a.data(), b.data(), w);
+}
+
+/*
+ * The minimized counters only depend on the number of addends and sum bits, so
+ * they are kept as clause templates over the variables 1..n+m, in memory and
+ * in a cache file shared by the runs of one user ($ESPRESSO_CACHE, default
+ * $TMPDIR/espresso-<uid>.cache; an empty $ESPRESSO_CACHE disables it). The file
+ * is a list of entries "qm2 n m k" followed by k 0-terminated clauses, one per
+ * line. The tag names the minimizer that wrote the entry; entries with another
+ * tag, or that do not fit their n, m and k, are skipped when loading.
+ */
+#define ESPRESSO_CACHE_TAG "qm2"
+
+typedef map<pair<unsigned int, unsigned int>, vector<vector<int>>> EspressoCache;
+
+static string espressoCachePath()
+{
+    const char *path = getenv("ESPRESSO_CACHE");
+    if ( path ) return path;
+    const char *tmp = getenv("TMPDIR");
+    return string(tmp && *tmp ? tmp : "/tmp") + "/espresso-" + to_string(getuid()) + ".cache";
+}
 
-            if (dup2(rfd[1], STDOUT_FILENO) == -1)
-                throw std::runtime_error("dup() failed");
+/* parses the first line of an entry, false if it is not one of this minimizer */
+static bool parseEspressoHeader(const char *line, unsigned int &n, unsigned int &m, unsigned int &k)
+{
+    char tag[8];
+    int len;
+    return sscanf(line, "%7s %u %u %u%n", tag, &n, &m, &k, &len) == 4
+           && strcmp(tag, ESPRESSO_CACHE_TAG) == 0 && line[len + strspn(line + len, " \r\n")] == 0
+           && n + m <= 64 && k <= (1u << 20);
+}
 
-            if (execlp("espresso", "espresso", 0) == -1)
-                throw std::runtime_error("execve() failed");
+/* parses a 0-terminated clause over the variables 1..nm, false if it is not one */
+static bool parseEspressoClause(const char *line, unsigned int nm, vector<int> &c)
+{
+    int lit, len;
+    while( sscanf(line, "%d%n", &lit, &len) == 1 )
+    {
+        line += len;
+        if ( lit == 0 ) return !c.empty() && c.size() <= nm;
+        if ( (unsigned int)abs(lit) > nm ) return false;
+        c.push_back(lit);
+    }
+    return false;
+}
 
-            exit(EXIT_FAILURE);
+static void loadEspressoCache(EspressoCache &cache)
+{
+    string path = espressoCachePath();
+    int fd = path.empty() ? -1 : open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+    if ( fd == -1 ) return;
+
+    /* only trust a file of this user, others may have planted it */
+    struct stat st;
+    FILE *f = fstat(fd, &st) == 0 && st.st_uid == getuid() ? fdopen(fd, "r") : NULL;
+    if ( !f )
+    {
+        close(fd);
+        return;
+    }
+
+    char *line = NULL;
+    size_t cap = 0;
+    bool more = getline(&line, &cap, f) != -1;
+    while( more )
+    {
+        unsigned int n, m, k;
+        if ( !parseEspressoHeader(line, n, m, k) )
+        {
+            more = getline(&line, &cap, f) != -1;                               // stale or corrupt, resynchronize
+            continue;
         }
 
-        close(wfd[0]);
-        close(rfd[1]);
+        vector<vector<int>> _clauses(k);
+        bool ok = true;
+        for( unsigned int i=0; i<k && ok; i++ )
+            ok = (more = getline(&line, &cap, f) != -1) && parseEspressoClause(line, n + m, _clauses[i]);
+        if ( ok )
+        {
+            /* exactly k clauses: the entry ends the file or another one starts */
+            more = getline(&line, &cap, f) != -1;
+            unsigned int nn, mm, kk;
+            if ( !more || parseEspressoHeader(line, nn, mm, kk) )
+                cache.insert(make_pair(make_pair(n, m), _clauses));
+        }
+        else if ( more && !parseEspressoHeader(line, n, m, k) )
+            more = getline(&line, &cap, f) != -1;
+    }
+    free(line);
+    fclose(f);
+}
 
-        FILE *eout = fdopen(wfd[1], "w");
-        if (!eout)
-            throw std::runtime_error("fdopen() failed");
+static void saveEspressoCache(unsigned int n, unsigned int m, const vector<vector<int>> &_clauses)
+{
+    string path = espressoCachePath();
+    if ( path.empty() ) return;
 
-        FILE *ein = fdopen(rfd[0], "r");
-        if (!ein)
-            throw std::runtime_error("fdopen() failed");
+    string entry = string(ESPRESSO_CACHE_TAG " ") + to_string(n) + " " + to_string(m) + " " + to_string(_clauses.size()) + "\n";
+    for( const vector<int> &c : _clauses )
+    {
+        for( int i : c )
+            entry += to_string(i) + " ";
+        entry += "0\n";
+    }
 
-        fprintf(eout, ".i %u\n", n + m);
-        fprintf(eout, ".o 1\n");
+    /* a single O_APPEND write, so that concurrent encoders do not interleave */
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_NOFOLLOW, 0600);
+    if ( fd == -1 ) return;
+    if ( write(fd, entry.data(), entry.size()) != (ssize_t)entry.size() )
+        fprintf(stderr, "Warning: could not write to the espresso cache %s\n", path.c_str());
+    close(fd);
+}
 
-        for (unsigned int i = 0; i < 1U << n; ++i)
+/*
+ * Two-level minimization of the counter relation "sum == number of true addends"
+ * over n addends and m sum bits, in the clause template format above (variables
+ * 1..n are the addends, variable n+1+q is sum bit m-1-q).
+ *
+ * Every clause blocks a cube of assignments violating the relation, so the
+ * clauses are a cover of the violating assignments by implicants. The cubes are
+ * indexed in base 3 (0/1 fixed, 2 free) and the implicants are found by one
+ * dynamic programming pass over all 3^(n+m) cubes (a cube is an implicant iff
+ * both its halves along some free variable are); the primes among them are then
+ * covered by the essential primes, lazy greedy set cover and a final pass that
+ * drops redundant primes, as espresso does.
+ */
+static void minimizeCounter(unsigned int n, unsigned int m, vector<vector<int>> &_clauses)
+{
+    int nv = n + m;
+    if ( nv > 16 )
+    {
+        fprintf(stderr, "Counter of %u addends and %u sum bits is too large to minimize!\n", n, m);
+        exit(1);
+    }
+
+    vector<long> pow3(nv + 1, 1);
+    for( int p=0; p<nv; p++ )
+        pow3[p+1] = pow3[p] * 3;
+
+    /* implicants */
+    vector<char> bad(pow3[nv]);
+    vector<int> digit(nv, 0);
+    for( long c=0; c<pow3[nv]; c++ )
+    {
+        int p = 0;
+        while( p < nv && digit[p] != 2 ) p++;
+        if ( p < nv )
+            bad[c] = bad[c - 2 * pow3[p]] && bad[c - pow3[p]];
+        else
         {
-            for (unsigned int j = 0; j < 1U << m; ++j)
+            unsigned int ones = 0, sum = 0;
+            for( int q=0; q<nv; q++ )
             {
-                for (unsigned int k = n; k--; )
-                    fprintf(eout, "%u", 1 - ((i >> k) & 1));
-                for (unsigned int k = m; k--; )
-                    fprintf(eout, "%u", 1 - ((j >> k) & 1));
-
-                fprintf(eout, " %u\n", __builtin_popcount(i) != j);
+                if ( q < (int)n ) ones += digit[q];
+                else sum = (sum << 1) | digit[q];
             }
+            bad[c] = ones != sum;
         }
 
-        fprintf(eout, ".e\n");
-        fflush(eout);
+        for( p=0; p<nv && ++digit[p] == 3; p++ )                                 // next cube
+            digit[p] = 0;
+    }
 
-        while (1)
+    /* primes, as (fixed values, free mask) over the minterm bits */
+    vector<pair<unsigned int, unsigned int>> primes;
+    fill(digit.begin(), digit.end(), 0);
+    for( long c=0; c<pow3[nv]; c++ )
+    {
+        bool prime = bad[c];
+        unsigned int value = 0, mask = 0;
+        for( int p=0; p<nv && prime; p++ )
         {
-            char buf[512];
-            if (!fgets(buf, sizeof(buf), ein))
-                break;
+            if ( digit[p] == 2 ) mask |= 1U << p;
+            else if ( bad[c + (2 - digit[p]) * pow3[p]] ) prime = false;
+            else value |= digit[p] << p;
+        }
+        if ( prime )
+            primes.push_back(make_pair(value, mask));
 
-            if (!strncmp(buf, ".i", 2))
-                continue;
-            if (!strncmp(buf, ".o", 2))
-                continue;
-            if (!strncmp(buf, ".p", 2))
-                continue;
-            if (!strncmp(buf, ".e", 2))
-                break;
+        for( int p=0; p<nv && ++digit[p] == 3; p++ )
+            digit[p] = 0;
+    }
+
+    /* minterms of a cube */
+    auto minterms = [](const pair<unsigned int, unsigned int> &cube, vector<unsigned int> &out)
+    {
+        out.clear();
+        unsigned int s = 0;
+        do {
+            out.push_back(cube.first | s);
+            s = (s - cube.second) & cube.second;
+        } while( s != 0 );
+    };
+
+    unsigned int size = 1U << nv;
+    vector<int> coverCnt(size, 0);
+    vector<unsigned int> ms;
+    for( auto &cube : primes )
+    {
+        minterms(cube, ms);
+        for( unsigned int x : ms ) coverCnt[x]++;
+    }
 
-            vector<int> c;
-            for (int i = 0; i < n + m; ++i)
+    vector<char> covered(size, 0), chosen(primes.size(), 0);
+    vector<int> solution;
+    auto take = [&](int i)
+    {
+        chosen[i] = 1;
+        solution.push_back(i);
+        minterms(primes[i], ms);
+        for( unsigned int x : ms ) covered[x] = 1;
+    };
+
+    /* essential primes */
+    for( size_t i=0; i<primes.size(); i++ )
+    {
+        minterms(primes[i], ms);
+        for( unsigned int x : ms )
+            if ( coverCnt[x] == 1 && !covered[x] )
             {
-                if (buf[i] == '0')
-                    c.push_back(-(i + 1));
-                else if (buf[i] == '1')
-                    c.push_back(i + 1);
+                take(i);
+                break;
             }
+    }
 
-            _clauses.push_back(c);
-        }
+    /* lazy greedy: the gain of a prime only decreases */
+    priority_queue<pair<int, int>> pq;
+    for( size_t i=0; i<primes.size(); i++ )
+        if ( !chosen[i] )
+            pq.push(make_pair(1 << __builtin_popcount(primes[i].second), -(int)i));
+    while( !pq.empty() )
+    {
+        int i = -pq.top().second;
+        pq.pop();
+        minterms(primes[i], ms);
+        int gain = 0;
+        for( unsigned int x : ms ) gain += !covered[x];
+        if ( gain == 0 ) continue;
+        if ( !pq.empty() && gain < pq.top().first )
+            pq.push(make_pair(gain, -i));
+        else
+            take(i);
+    }
 
-        fclose(ein);
-        fclose(eout);
+    /* drop primes whose minterms are all covered by others, smallest first */
+    fill(coverCnt.begin(), coverCnt.end(), 0);
+    for( int i : solution )
+    {
+        minterms(primes[i], ms);
+        for( unsigned int x : ms ) coverCnt[x]++;
+    }
+    sort(solution.begin(), solution.end(), [&](int a, int b){
+            return make_pair(__builtin_popcount(primes[a].second), a) < make_pair(__builtin_popcount(primes[b].second), b); });
+    vector<int> kept;
+    for( int i : solution )
+    {
+        minterms(primes[i], ms);
+        bool redundant = true;
+        for( unsigned int x : ms ) redundant = redundant && coverCnt[x] > 1;
+        if ( redundant )
+            for( unsigned int x : ms ) coverCnt[x]--;
+        else
+            kept.push_back(i);
+    }
+    sort(kept.begin(), kept.end());
 
-        while (true)
-        {
-            int status;
-            pid_t kid = wait(&status);
-            if (kid == -1)
-            {
-                if (errno == ECHILD)
-                    break;
-                if (errno == EINTR)
-                    continue;
+    for( int i : kept )
+    {
+        vector<int> c;
+        for( int p=0; p<nv; p++ )
+            if ( !(primes[i].second >> p & 1) )
+                c.push_back((primes[i].first >> p & 1) ? -(p + 1) : p + 1);
+        _clauses.push_back(c);
+    }
+}
 
-                throw std::runtime_error("wait() failed");
-            }
+void Formula::espresso(const vector<int> &lhs, const vector<int> &rhs)
+{
+    static EspressoCache cache;
+    static bool cacheLoaded = false;
+    static mutex cacheLock;                                                     // sub-formulas may be built on several threads
 
-            if (kid == child)
-                break;
-        }
+    unsigned int n = lhs.size();
+    unsigned int m = rhs.size();
 
-        cache.insert(make_pair(make_pair(n, m), _clauses));
+    unique_lock<mutex> lock(cacheLock);
+    if ( !cacheLoaded )
+    {
+        loadEspressoCache(cache);
+        cacheLoaded = true;
+    }
+
+    auto it = cache.find(make_pair(n, m));
+    if (it == cache.end())
+    {
+        vector<vector<int>> _clauses;
+        minimizeCounter(n, m, _clauses);
+
+        saveEspressoCache(n, m, _clauses);
+        it = cache.insert(make_pair(make_pair(n, m), _clauses)).first;
 
 #ifdef _DUMP_ADDER_CLAUSES_
         FILE *f = fopen("comp_clauses.txt", "a");
@@ -646,51 +1273,190 @@ void Formula::espresso(const vector<int> &lhs, const vector<int> &rhs)
 #endif
     }
 
-    for(vector<int> &c: _clauses)
+    const vector<vector<int>> &_clauses = it->second;                          // map entries never move
+    lock.unlock();
+
+    int cl[n + m];
+    for(const vector<int> &c: _clauses)
     {
-        Clause cl;
-        for (int i: c)
+        for (size_t k = 0; k < c.size(); ++k)
         {
-            int j = abs(i) - 1;
+            int j = abs(c[k]) - 1;
             int var = j < n ? lhs[j] : rhs[m - 1 - (j - n)];
-            if ( i < 0 )
-                cl.lits.push_back(-var);
-            else
-                cl.lits.push_back(var);
+            cl[k] = c[k] < 0 ? -var : var;
         }
 
-        addClause(cl);
+        addClause(cl, c.size());
     }
 }
 
 
 void Formula::dimacs(bool header)
 {
+    if ( sink )
+    {
+        flushBuffer();
+        if ( spill )
+        {
+            if ( header )
+                fprintf(sink, "p cnf %d %d\n", getVarCnt(), getClauseCnt());
+            rewind(spill);
+            size_t len;
+            while( (len = fread(&buf[0], 1, buf.size(), spill)) > 0 )
+                fwrite(&buf[0], 1, len, sink);
+            fclose(spill);
+            spill = NULL;
+        }
+        else
+        {
+            /* fill in the placeholder header and return to the end */
+            char line[HEADER_LEN + 1];
+            snprintf(line, sizeof(line), "p cnf %d %d", getVarCnt(), getClauseCnt());
+            fflush(sink);
+            fseek(sink, headerPos, SEEK_SET);
+            fprintf(sink, "%-*s", HEADER_LEN - 1, header ? line : "c");
+            fseek(sink, 0, SEEK_END);
+        }
+
+        for( auto e : varNames )
+            fprintf(sink, "c %s %d\n", e.first.c_str(), e.second);
+        fflush(sink);
+        sink = NULL;
+        return;
+    }
+
     if ( header )
         printf("p cnf %d %d\n", getVarCnt(), getClauseCnt());
 
-    for( Clause c : clauses )
-    {
-        if ( c.xor_clause ) printf("x ");
-        for( int v : c.lits )
-            printf("%d ", v);
-        printf("0\n");
-    }
+    writeClauses(stdout);
 
     for( auto e : varNames )
         printf("c %s %d\n", e.first.c_str(), e.second);
 }
 
-int Formula::clauseCheck()
+void Formula::stream(FILE *out)
 {
-    for( Clause c : clauses )
+    sink = out;
+    buf.resize(1 << 20);
+    bufLen = 0;
+
+    fflush(sink);
+    headerPos = ftell(sink);
+    if ( headerPos >= 0 && fseek(sink, headerPos, SEEK_SET) == 0 )
+        fprintf(sink, "%*s\n", HEADER_LEN - 1, "");
+    else
     {
-        for( int v : c.lits )
+        headerPos = -1;
+        spill = tmpfile();
+        if ( !spill )
         {
-            if ( abs(v) > getVarCnt() ) { fprintf(stderr, "Clause check failed: out of bound variable ID (%d)! var_cnt == %d\n", v, getVarCnt()); abort(); }
-            if ( v == 0 ) { fprintf(stderr, "Clause check failed: variable ID is zero!\n"); abort(); }
+            fprintf(stderr, "Cannot create a temporary file for streaming!\n");
+            exit(1);
         }
+    }
 
+    /* Everything added so far goes out first */
+    for( int i=0; i<(int)clauses.size(); i++ )
+    {
+        Clause c = getClause(i);
+        writeClause(c.lits, c.size, c.xor_clause);
+    }
+    vector<int>().swap(lits);
+    vector<ClauseRef>().swap(clauses);
+}
+
+void Formula::stream(ClauseHandler h)
+{
+    handler = h;
+    for( int i=0; i<(int)clauses.size(); i++ )
+    {
+        Clause c = getClause(i);
+        writeClause(c.lits, c.size, c.xor_clause);
+    }
+    vector<int>().swap(lits);
+    vector<ClauseRef>().swap(clauses);
+}
+
+/* writes 'c' as a DIMACS line at 'p' (at most 12 * (n + 1) + 2 chars), returns its end */
+static char *formatClause(char *p, const int *c, int n, bool xorC)
+{
+    if ( xorC )
+    {
+        *p++ = 'x';
+        *p++ = ' ';
+    }
+    for( int i=0; i<n; i++ )
+    {
+        /* digits are produced backwards into 'tmp' */
+        char tmp[12];
+        int len = 0;
+        unsigned v = c[i] < 0 ? -(unsigned)c[i] : c[i];
+        do {
+            tmp[len++] = '0' + v % 10;
+            v /= 10;
+        } while( v );
+
+        if ( c[i] < 0 ) *p++ = '-';
+        while( len ) *p++ = tmp[--len];
+        *p++ = ' ';
+    }
+    *p++ = '0';
+    *p++ = '\n';
+    return p;
+}
+
+void Formula::writeClause(const int *c, int n, bool xorC)
+{
+    if ( handler )
+    {
+        handler(c, n, xorC);
+        streamedCnt++;
+        return;
+    }
+
+    if ( bufLen + 12 * (n + 1) + 2 > buf.size() )
+        flushBuffer();
+    if ( 12 * (size_t)(n + 1) + 2 > buf.size() )
+        buf.resize(12 * (n + 1) + 2);
+
+    bufLen = formatClause(&buf[bufLen], c, n, xorC) - &buf[0];
+    streamedCnt++;
+}
+
+void Formula::writeClauses(FILE *out) const
+{
+    vector<char> text(1 << 20);
+    size_t len = 0;
+    for( const ClauseRef &r : clauses )
+    {
+        size_t need = 12 * (r.size + 1) + 2;
+        if ( len + need > text.size() )
+        {
+            fwrite(&text[0], 1, len, out);
+            len = 0;
+            if ( need > text.size() ) text.resize(need);
+        }
+        len = formatClause(&text[len], &lits[r.offset], r.size, r.xor_clause) - &text[0];
+    }
+    fwrite(&text[0], 1, len, out);
+}
+
+void Formula::flushBuffer()
+{
+    if ( bufLen && fwrite(&buf[0], 1, bufLen, spill ? spill : sink) != bufLen )
+    {
+        fprintf(stderr, "Writing the formula failed!\n");
+        exit(1);
+    }
+    bufLen = 0;
+}
+
+int Formula::clauseCheck()
+{
+    for( int v : lits )
+    {
+        if ( abs(v) > getVarCnt() ) { fprintf(stderr, "Clause check failed: out of bound variable ID (%d)! var_cnt == %d\n", v, getVarCnt()); abort(); }
+        if ( v == 0 ) { fprintf(stderr, "Clause check failed: variable ID is zero!\n"); abort(); }
     }
     return 0;
 }
@@ -793,16 +1559,91 @@ void Formula::cardinality(int *vars, int n, unsigned cardinalValue)
     }
 }
 
-vector<Clause> Formula::getClauses()
+void Formula::AddFormula(Formula& f)
+{
+    /* variables of a sub-formula are moved right after the ones of this formula */
+    int base = f.subBase, shift = varID - f.subBase;
+    auto relabel = [&](int x) { return !base || abs(x) <= base ? x : x > 0 ? x + shift : x - shift; };
+
+    varCnt += f.getVarCnt();
+    if ( sink || handler )
+    {
+        vector<int> c;
+        for( int i=0; i<(int)f.clauses.size(); i++ )
+        {
+            Clause cl = f.getClause(i);
+            c.assign(cl.begin(), cl.end());
+            for( int &x : c ) x = relabel(x);
+            writeClause(c.data(), c.size(), cl.xor_clause);
+        }
+    }
+    else
+    {
+        unsigned long offset = lits.size();
+        lits.insert(lits.end(), f.lits.begin(), f.lits.end());
+        if ( base )
+            for( unsigned long i=offset; i<lits.size(); i++ )
+                lits[i] = relabel(lits[i]);
+        clauses.reserve(clauses.size() + f.clauses.size());
+        for( ClauseRef r : f.clauses )
+        {
+            r.offset += offset;
+            clauses.push_back(r);
+        }
+    }
+
+    if ( base )
+    {
+        varID += f.getVarCnt();
+        for( auto e : f.varNames )
+            varNames[e.first] = relabel(e.second);
+        for( auto e : f.constant )
+            constant[relabel(e.first)] = e.second;
+        for( auto e : f.gates )
+        {
+            GateKey k = e.first;
+            for( int j=1; j<4; j++ ) k[j] = relabel(k[j]);
+            gates[k] = relabel(e.second);
+        }
+    }
+    else
+        for( auto e : f.varNames )
+            varNames[e.first + "_" + f.formulaName] = e.second;
+}
+
+void Formula::subFormula(Formula &sub)
 {
-    return clauses;
+    sub.varID = SUB_BASE;
+    sub.varCnt = 0;
+    sub.subBase = SUB_BASE;
+    sub.parent = this;
+    sub.structuralHashing = structuralHashing;
+    sub.useXORClauses = useXORClauses;
+    sub.useFACardinality = useFACardinality;
+    sub.adderType = adderType;
+    sub.multiAdderType = multiAdderType;
+    sub.treeType = treeType;
 }
 
-void Formula::AddFormula(Formula& f)
+void Formula::parallel(int cnt, int threads, function<void(Formula&, int)> part)
 {
-    varCnt += f.getVarCnt();
-    vector<Clause> c = f.getClauses();
-    clauses.insert(clauses.end(), c.begin(), c.end());
-    for( auto e : f.varNames )
-        varNames[e.first + "_" + f.formulaName] = e.second;
+    if ( threads < 1 ) threads = 1;
+    for( int b=0; b<cnt; b+=threads )
+    {
+        int e = min(cnt, b + threads);
+        vector<Formula> subs(e - b);
+        vector<thread> workers;
+        for( int i=b; i<e; i++ )
+        {
+            subFormula(subs[i-b]);
+            if ( threads == 1 )
+                part(subs[i-b], i);
+            else
+                workers.push_back(thread(part, ref(subs[i-b]), i));
+        }
+        for( thread &t : workers )
+            t.join();
+        for( Formula &sub : subs )
+            AddFormula(sub);
+    }
 }
@@ -1,27 +1,33 @@
 #ifndef _FORMULA_H_
 #define _FORMULA_H_
 
+#include <stdio.h>
 #include <vector>
 #include <string>
 #include <map>
 #include <queue>
 #include <algorithm>
+#include <initializer_list>
+#include <functional>
+#include <array>
+#include <unordered_map>
 
 using namespace std;
 
+/*
+ * A clause of a Formula: 'size' literals in the literal arena of the formula,
+ * valid until the next clause is added. XOR clauses (written as 'x ... 0' in
+ * DIMACS) are flagged by 'xor_clause'.
+ */
 struct Clause
 {
-    vector<int> lits;
+    const int *lits;
+    unsigned size;
     bool xor_clause;
-    Clause(vector<int> v, bool xorC = false)
-    {
-        xor_clause = xorC;
-        lits = v;
-    }
-    Clause()
-    {
-        xor_clause = false;
-    }
+
+    const int *begin() const { return lits; }
+    const int *end() const { return lits + size; }
+    int operator[](int i) const { return lits[i]; }
 };
 
 class Formula
@@ -32,24 +38,39 @@ class Formula
 
         void newVars(int *x, int n = 32, string name = "");                     // Reserves new variable IDs for the bitvector 'x' of size 'n'
 
-        void addClause(vector<int> v);
-        void addClause(Clause c);
+        void addClause(initializer_list<int> c, bool xorC = false) { addClause(c.begin(), c.size(), xorC); }
+        void addClause(const vector<int> &c, bool xorC = false) { addClause(c.data(), c.size(), xorC); }
+        void addClause(const int *c, int n, bool xorC = false);                 // Copies the 'n' literals at 'c' into the arena
 
         void fixedValue(int *z, unsigned v, int n = 32);                        // Forces the bitvector 'z' to the value 'v'
 
         int getVarCnt() { return varCnt; }
-        int getClauseCnt() { return clauses.size(); }
+        int getClauseCnt() { return clauses.size() + streamedCnt; }
+        Clause getClause(int i) const                                           // Only for clauses kept in the arena (not streamed)
+        {
+            Clause c = { lits.data() + clauses[i].offset, clauses[i].size, clauses[i].xor_clause != 0 };
+            return c;
+        }
 
         enum AdderType {
             AT_NONE,
             RIPPLE_CARRY,
+            KOGGE_STONE,              // Parallel prefix carries, log(n) levels of n cells
+            BRENT_KUNG,               // Parallel prefix carries, 2 log(n) levels of about 2n cells in total
+        };
+
+        enum TreeType {
+            TT_NONE,
+            WALLACE,                  // Every column reduced by as many full (and half) adders as fit in each stage
+            DADDA,                    // As few adders per stage as the Dadda height sequence allows
+            COMPRESSOR_42,            // 4:2 compressors (two full adders, the carry between them goes sideways)
         };
 
         enum MultiAdderType {
             MAT_NONE,
             TWO_OPERAND,              // Adding two operands at a time
             COUNTER_CHAIN,            // Using counters (adding up bits in a single column) in a ripple carry fashion
-            ESPRESSO,                 // Similar to COUNTER_CHAIN, but uses espresso logic minimizer instead of half/full adders
+            ESPRESSO,                 // Similar to COUNTER_CHAIN, but uses minimized counter clauses (espresso-style, built in) instead of half/full adders
             DOT_MATRIX,               // Reducing the whole dot matrix of operand bits using wallace tree (and half/full adders)
         };
 
@@ -58,8 +79,26 @@ class Formula
         void setUseFACardinality() { useFACardinality = true; }
         void setAdderType(AdderType type) { adderType = type; }
         void setMultiAdderType(MultiAdderType type) { multiAdderType = type; }
+        void setTreeType(TreeType type) { treeType = type; }
+        /* Folds constants into gates and reuses gates built on the same inputs. The
+         * sub-formulas built at the same time by parallel() cannot reuse each other's
+         * gates, so the formula (not its solutions) depends on the number of threads. */
+        void setStructuralHashing() { structuralHashing = true; }
 
         void dimacs(bool header = true);                                        // Prints the current clause database in DIMACS format to stdout
+        void writeClauses(FILE *out) const;                                     // Writes the clauses kept in the arena, without header and comments
+
+        /* Streams the formula to 'out' instead of keeping it: the clauses so far and
+         * every clause added afterwards are written out immediately (a seekable 'out'
+         * gets a placeholder header, anything else a temporary spill file) and
+         * dimacs() finishes the file by fixing up the header. */
+        void stream(FILE *out);
+
+        /* Same, but every clause goes to 'handler' (its literals, their count and
+         * whether it is an XOR clause) instead of a file, e.g. to add it to a
+         * solver through its API without the DIMACS text (see cmsat.h) */
+        typedef function<void(const int *, int, bool)> ClauseHandler;
+        void stream(ClauseHandler h);
 
         /* operations */
         void rotl(int *z, int *x, int p, int n = 32);                           // Rotate left 'p' postitions
@@ -83,15 +122,24 @@ class Formula
         void add3(int *z, int *a, int *b, int *c, int n = 32);                  // z = a + b + c;
         void add4(int *z, int *a, int *b, int *c, int *d, int n = 32);          // z = a + b + c + d;
         void add5(int *z, int *a, int *b, int *c, int *d, int *e, int n = 32);  // z = a + b + c + d + e;
+        void prefixAdd(int *z, int *x, int *y, int n = 32);                     // z = x + y; with the carries of the adder type
+        void addColumns(int *z, vector<vector<int>> cols);                      // z = sum of the dot matrix 'cols' (bits of weight 2^i in cols[i]) by the tree type
 
 
-        void cardinality(int *vars, int n, unsigned cardinalValue);             // Cardinality constraints: vars[0]+vars[1]+...+vars[n-1] == cardinalValue 
+        void cardinality(int *vars, int n, unsigned cardinalValue);             // Cardinality constraints: vars[0]+vars[1]+...+vars[n-1] == cardinalValue (other encodings: cardinality.h)
 
         int clauseCheck();                                                      // Mainly for debugging. Checks trivial invalid clauses 
 
-        vector<Clause> getClauses();
         void AddFormula(Formula& f);
 
+        /* Independent parts of an encoding. A sub-formula sees every variable of this
+         * formula created so far and takes its new variables from a reserved range
+         * above them; AddFormula() renumbers those to follow the variables of this
+         * formula, so merging sub-formulas in order gives the same formula as
+         * building the parts here one after the other. */
+        void subFormula(Formula &sub);
+        void parallel(int cnt, int threads, function<void(Formula&, int)> part); // Builds part(sub, i) for i < cnt on sub-formulas, 'threads' at a time, and merges them in order
+
         map<string, unsigned int> varNames;                                     // labels for variable IDs
         string formulaName;
 
@@ -101,11 +149,61 @@ class Formula
         bool useFACardinality;
         AdderType adderType;
         MultiAdderType multiAdderType;
-        vector<Clause> clauses;
-
-        void espresso(const vector<int> &lhs, const vector<int> &rhs);             // deriving lhs = addition(rhs), through espresso minimization;
+        TreeType treeType;
+
+        /* All literals are kept back to back in 'lits'; a clause is an index into it */
+        struct ClauseRef
+        {
+            unsigned long offset;
+            unsigned size : 31;
+            unsigned xor_clause : 1;
+        };
+        vector<int> lits;
+        vector<ClauseRef> clauses;
+
+        /* streaming sink */
+        FILE *sink;
+        FILE *spill;                                                            // clauses waiting for the header when 'sink' is not seekable
+        long headerPos;                                                         // placeholder header in 'sink', or -1
+        vector<char> buf;
+        size_t bufLen;
+        int streamedCnt;
+        ClauseHandler handler;
+
+        int subBase;                                                            // first variable ID of a sub-formula minus one, 0 otherwise
+        const Formula *parent;                                                  // formula a sub-formula was made from
+
+        /* structural hashing: gates are keyed by their type and (normalized) input
+         * literals, constants are the variables fixed by fixedValue() or by folding */
+        enum GateType {
+            G_AND,
+            G_XOR,
+            G_XOR3,
+            G_MAJ,
+            G_CH,
+        };
+        typedef array<int, 4> GateKey;
+        bool structuralHashing;
+        map<GateKey, int> gates;                                                // output literal of every gate
+        unordered_map<int, bool> constant;
+
+        int value(int l) const;                                                 // 1 if the literal 'l' is known to be true, -1 if false, 0 otherwise
+        void setValue(int l, bool v);
+        int findGate(const GateKey &k) const;
+        void equiv(int z, int l);                                               // z == l
+        void andGate(int z, int x, int y);
+        void xorGate(int z, int x, int y);
+        void xor3Gate(int z, int x, int y, int t);
+        void majGate(int z, int x, int y, int t);
+        void chGate(int z, int x, int y, int t);
+
+        void writeClause(const int *c, int n, bool xorC);
+        void flushBuffer();
+
+        void espresso(const vector<int> &lhs, const vector<int> &rhs);             // deriving lhs = addition(rhs), through two-level logic minimization;
 
         void counter(int *z, int *x, int n);
+        void prefixCell(int &g, int &p, int gl, int pl, bool needP);             // (g, p) = (g, p) o (gl, pl)
 
     private:
 };
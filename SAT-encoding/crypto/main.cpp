@@ -6,6 +6,12 @@
 #include <unistd.h>
 #include <assert.h>
 #include <getopt.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#ifdef _CRYPTOMINISAT_
+#include "cmsat.h"
+#endif
 
 enum FuncType {
     FT_SHA1,
@@ -21,12 +27,40 @@ enum AnalysisType {
 
 /* config options */
 int cfg_use_xor_clauses;
+int cfg_hash_gates;
 Formula::MultiAdderType cfg_multi_adder_type;
 int cfg_use_rand;
 int cfg_print_target;
+int cfg_stream;
+int cfg_solve;
+int cfg_threads;
+int cfg_batch;
+const char *cfg_output;
 FuncType cfg_function;
 AnalysisType cfg_analysis;
 
+#ifdef _CRYPTOMINISAT_
+/* Solves the instance added to 's' and prints the result with the message words 'w' of a solution */
+void solve(CMSat::SATSolver &s, int w[][32])
+{
+    CMSat::lbool r = s.solve();
+    if ( r == CMSat::l_True )
+    {
+        printf("s SATISFIABLE\nc message");
+        for( int i=0; i<16; i++ )
+        {
+            unsigned x = 0;
+            for( int b=0; b<32; b++ )
+                if ( modelValue(s, w[i][b]) ) x |= 1u << b;
+            printf(" %08x", x);
+        }
+        printf("\n");
+    }
+    else
+        printf(r == CMSat::l_False ? "s UNSATISFIABLE\n" : "s INDETERMINATE\n");
+}
+#endif
+
 
 void preimage(int rounds)
 {
@@ -34,7 +68,14 @@ void preimage(int rounds)
     {
         SHA1 f(rounds);
         if ( cfg_use_xor_clauses ) f.cnf.setUseXORClauses();
+        if ( cfg_hash_gates ) f.cnf.setStructuralHashing();
         if ( cfg_multi_adder_type != Formula::MAT_NONE ) f.cnf.setMultiAdderType(cfg_multi_adder_type);
+        if ( cfg_stream && !cfg_print_target ) f.cnf.stream(stdout);
+#ifdef _CRYPTOMINISAT_
+        CMSat::SATSolver solver;
+        if ( cfg_solve && !cfg_print_target ) addToSolver(f.cnf, solver);
+#endif
+        f.threads = cfg_threads;
         f.encode();
 
         unsigned w[80];
@@ -83,6 +124,10 @@ void preimage(int rounds)
         /* Set hash target bits */
         f.fixOutput(hash);
 
+#ifdef _CRYPTOMINISAT_
+        if ( cfg_solve ) { solve(solver, f.w); return; }
+#endif
+
 	for( auto e : f.cnf.varNames )
         printf("c %s %d\n", e.first.c_str(), e.second);
 
@@ -93,7 +138,14 @@ void preimage(int rounds)
     {
         SHA256 f(rounds);
         if ( cfg_use_xor_clauses ) f.cnf.setUseXORClauses();
+        if ( cfg_hash_gates ) f.cnf.setStructuralHashing();
         if ( cfg_multi_adder_type != Formula::MAT_NONE ) f.cnf.setMultiAdderType(cfg_multi_adder_type);
+        if ( cfg_stream && !cfg_print_target ) f.cnf.stream(stdout);
+#ifdef _CRYPTOMINISAT_
+        CMSat::SATSolver solver;
+        if ( cfg_solve && !cfg_print_target ) addToSolver(f.cnf, solver);
+#endif
+        f.threads = cfg_threads;
         f.encode();
 
         unsigned w[64];
@@ -146,8 +198,10 @@ void preimage(int rounds)
         /* Set hash target bits */
         f.fixOutput(hash);
 
-	f.cnf.dimacs();
-	
+#ifdef _CRYPTOMINISAT_
+        if ( cfg_solve ) { solve(solver, f.w); return; }
+#endif
+
         /* Printing out the instance */
         f.cnf.dimacs();
     }
@@ -157,11 +211,88 @@ void preimage(int rounds)
     }
 }
 
+/* Encodes the circuit of 'f' once and writes 'cfg_batch' preimage instances with
+ * random targets to '<cfg_output><i>.cnf', 'cfg_threads' files at a time. Every
+ * instance is the shared circuit plus the unit clauses of its target. */
+template<class Hash>
+void batch(Hash &f, int words, void (*comp)(unsigned *, unsigned *, int, bool))
+{
+    if ( cfg_use_xor_clauses ) f.cnf.setUseXORClauses();
+    if ( cfg_hash_gates ) f.cnf.setStructuralHashing();
+    if ( cfg_multi_adder_type != Formula::MAT_NONE ) f.cnf.setMultiAdderType(cfg_multi_adder_type);
+    f.threads = cfg_threads;
+    f.encode();
+
+    /* Targets are drawn up front, so the instances only depend on the seed */
+    vector<vector<unsigned>> msg(cfg_batch), hash(cfg_batch);
+    for( int i=0; i<cfg_batch; i++ )
+    {
+        unsigned w[80], h[8];
+        for( int j=0; j<16; j++ )
+            w[j] = lrand48();
+        comp(w, h, f.rounds, false);
+        msg[i].assign(w, w + 16);
+        hash[i].assign(h, h + words);
+    }
+
+    /* The circuit, formatted once */
+    char *text = NULL;
+    size_t len = 0;
+    FILE *mem = open_memstream(&text, &len);
+    f.cnf.writeClauses(mem);
+    fclose(mem);
+
+    atomic<int> next(0);
+    atomic<bool> failed(false);
+    auto worker = [&]()
+    {
+        for( int i; (i = next++) < cfg_batch; )
+        {
+            string name = cfg_output + to_string(i) + ".cnf";
+            FILE *out = fopen(name.c_str(), "w");
+            if ( !out )
+            {
+                fprintf(stderr, "Cannot open %s\n", name.c_str());
+                failed = true;
+                return;
+            }
+
+            fprintf(out, "p cnf %d %d\n", f.cnf.getVarCnt(), f.cnf.getClauseCnt() + 32 * words);
+            fprintf(out, "c message");
+            for( unsigned x : msg[i] ) fprintf(out, " %08x", x);
+            fprintf(out, "\nc target");
+            for( unsigned x : hash[i] ) fprintf(out, " %08x", x);
+            fprintf(out, "\n");
+
+            fwrite(text, 1, len, out);
+            for( int j=0; j<words; j++ )
+                for( int b=0; b<32; b++ )
+                    fprintf(out, "%d 0\n", (hash[i][j] >> b) & 1 ? f.out[j][b] : -f.out[j][b]);
+
+            for( auto e : f.cnf.varNames )
+                fprintf(out, "c %s %d\n", e.first.c_str(), e.second);
+            fclose(out);
+        }
+    };
+
+    vector<thread> workers;
+    for( int t=1; t<cfg_threads; t++ )
+        workers.push_back(thread(worker));
+    worker();
+    for( thread &t : workers )
+        t.join();
+    free(text);
+
+    if ( failed ) exit(1);
+}
+
 void display_usage()
 {
     printf("USAGE: ./main {number_of_rounds}\n"
             "  --help or -h                             Prints this message\n"
             "  --xor                                    Use XOR clauses (default: off)\n"
+            "  --hash_gates                             Fold constants into gates and reuse identical gates (default: off);\n"
+            "                                           the rounds built in parallel do not share gates, so the CNF depends on -j\n"
             "  --adder_type or -A {two_operand | counter_chain | espresso | dot_matrix}\n"
             "                                           Specifies the type of multi operand addition encoding (default: espresso)\n"
             "  --random_target                          Generate a random input/target pair (instead of reading from stdin)\n"
@@ -169,6 +300,14 @@ void display_usage()
             "  --function or -f {sha1 | sha256}         Type of function under analysis (default: sha1)\n"
             "  --analysis or -a {preimage | collision}  Type of analysis (default: preimage)\n"
             "  --print_target                           Prints the randomly generated message/target and exits (--random_target should be given)\n"
+            "  --stream                                 Writes clauses out while encoding instead of keeping them in memory\n"
+            "  --threads or -j {int}                    Number of threads building the rounds / writing the batch (default: 1)\n"
+            "  --batch or -b {int}                      Encodes once and writes int preimage instances with random targets\n"
+            "  --output or -o {prefix}                  File name prefix of the batch instances, '<prefix><i>.cnf' (default: instance_)\n"
+            "  --seed or -s {int}                       Random seed (default: time)\n"
+#ifdef _CRYPTOMINISAT_
+            "  --solve                                  Solves the instance with cryptominisat instead of printing it\n"
+#endif
           );
 }
 
@@ -179,9 +318,15 @@ int main(int argc, char **argv)
 
     /* Arguments default values */
     cfg_use_xor_clauses = 0;
+    cfg_hash_gates = 0;
     cfg_multi_adder_type = Formula::MAT_NONE;
     cfg_use_rand = 0;
     cfg_print_target = 0;
+    cfg_stream = 0;
+    cfg_solve = 0;
+    cfg_threads = 1;
+    cfg_batch = 0;
+    cfg_output = "instance_";
     cfg_function = FT_SHA1;
     cfg_analysis = AT_PREIMAGE;
     int rounds = -1;
@@ -190,20 +335,29 @@ int main(int argc, char **argv)
     {
         /* flag options */
         {"xor",           no_argument, &cfg_use_xor_clauses,   1},
+        {"hash_gates",    no_argument, &cfg_hash_gates,        1},
         {"random_target", no_argument, &cfg_use_rand,          1},
         {"print_target",  no_argument, &cfg_print_target,      1},
+        {"stream",        no_argument, &cfg_stream,            1},
+#ifdef _CRYPTOMINISAT_
+        {"solve",         no_argument, &cfg_solve,             1},
+#endif
         /* valued options */
         {"rounds",   required_argument, 0, 'r'},
         {"function", required_argument, 0, 'f'},
         {"analysis", required_argument, 0, 'a'},
         {"adder_type", required_argument, 0, 'A'},
+        {"threads",  required_argument, 0, 'j'},
+        {"batch",    required_argument, 0, 'b'},
+        {"output",   required_argument, 0, 'o'},
+        {"seed",     required_argument, 0, 's'},
         {"help",     no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
 
     /* Process command line */
     int c, option_index;
-    while( (c = getopt_long(argc, argv, "a:r:f:A:h", long_options, &option_index)) != -1 )
+    while( (c = getopt_long(argc, argv, "a:r:f:A:j:b:o:s:h", long_options, &option_index)) != -1 )
     {
         switch ( c )
         {
@@ -221,6 +375,22 @@ int main(int argc, char **argv)
                 rounds = atoi(optarg);
                 break;
 
+            case 'j':
+                cfg_threads = atoi(optarg);
+                break;
+
+            case 'b':
+                cfg_batch = atoi(optarg);
+                break;
+
+            case 'o':
+                cfg_output = optarg;
+                break;
+
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
             case 'a':
                 cfg_analysis = strcmp(optarg, "preimage") == 0 ? AT_PREIMAGE :
                     strcmp(optarg, "collision") == 0 ? AT_COLLISION : 
@@ -282,11 +452,29 @@ int main(int argc, char **argv)
         fprintf(stderr, "Number of rounds is required! Use -r or --rounds\n");
         return 1;
     }
+    if ( cfg_stream && cfg_solve )
+    {
+        fprintf(stderr, "--stream and --solve cannot be combined!\n");
+        return 1;
+    }
 
     srand(seed);
     srand48(rand());
 
-    if ( cfg_analysis == AT_PREIMAGE )
+    if ( cfg_batch > 0 && cfg_analysis == AT_PREIMAGE )
+    {
+        if ( cfg_function == FT_SHA1 )
+        {
+            SHA1 f(rounds);
+            batch(f, 5, sha1_comp);
+        }
+        else
+        {
+            SHA256 f(rounds);
+            batch(f, 8, sha256_comp);
+        }
+    }
+    else if ( cfg_analysis == AT_PREIMAGE )
         preimage(rounds);
     else
     {
@@ -5,6 +5,7 @@ SHA1::SHA1(int rnds, bool initBlock)
 {
     rounds = rnds;
     initialBlock = initBlock;
+    threads = 1;
 }
 
 void SHA1::encode()
@@ -57,8 +58,8 @@ void SHA1::encode()
     cnf.rotl(a[1], in[3], 2);
     cnf.rotl(a[0], in[4], 2);
 
-    /* Main loop */
-    for( int i=0; i<rounds; i++ )
+    /* Main loop. Rounds only share the variables above, so they are built in parallel */
+    cnf.parallel(rounds, threads, [&](Formula &cnf, int i)
     {
         int prev_a[32], b[32], c[32], d[32], e[32];
         cnf.rotl(prev_a, a[i+4], 5);
@@ -88,7 +89,7 @@ void SHA1::encode()
         }
 
         cnf.add5(a[i + 5], prev_a, f, e, k[i/20], w[i]);
-    }
+    });
 
     /* Rotate back */
     int c[32];
@@ -16,6 +16,7 @@ class SHA1 {
         int a[85][32];
         int rounds;
         bool initialBlock;
+        int threads;                                                            // for building the rounds
 
         Formula cnf;
 };
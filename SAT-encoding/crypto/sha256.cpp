@@ -4,6 +4,7 @@ SHA256::SHA256(int rnds, bool initBlock)
 {
     rounds = rnds;
     initialBlock = initBlock;
+    threads = 1;
 }
 
 void SHA256::encode()
@@ -24,8 +25,9 @@ void SHA256::encode()
     }
 
     /* Message expansion */
-    for( int i=16; i<rounds; i++ )
+    cnf.parallel(max(rounds - 16, 0), threads, [&](Formula &cnf, int j)
     {
+        int i = j + 16;
         int s0[32], s1[32];
         cnf.newVars(s0);
         cnf.newVars(s1);
@@ -42,7 +44,7 @@ void SHA256::encode()
         cnf.xor3(s1, r1, r2, w[i-2]+10, 22);
 
         cnf.add4(w[i], w[i-16], s0, w[i-7], s1);
-    }
+    });
 
     /* Round constants */
     unsigned rnd_const[] = {
@@ -85,13 +87,13 @@ void SHA256::encode()
     cnf.assign(E[0], in[7]);
 
     /* Main loop */
-    for( int i=0; i<rounds; i++ )
+    cnf.parallel(rounds, threads, [&](Formula &cnf, int i)
     {
         int sigma0[32], sigma1[32];
         cnf.newVars(sigma0);
         cnf.newVars(sigma1);
-        Sigma0(sigma0, A[i+3]);
-        Sigma1(sigma1, E[i+3]);
+        Sigma0(cnf, sigma0, A[i+3]);
+        Sigma1(cnf, sigma1, E[i+3]);
 
         int f1[32], f2[32];
         cnf.newVars(f1);
@@ -106,7 +108,7 @@ void SHA256::encode()
         cnf.add2(E[i+4], A[i], T);
 
         cnf.add3(A[i+4], T, sigma0, f2);
-    }
+    });
 
     /* Final addition */
     cnf.add2(out[0], in[0], A[rounds+3]);
@@ -125,7 +127,7 @@ void SHA256::fixOutput(unsigned target[8])
         cnf.fixedValue(out[i], target[i]);
 }
 
-void SHA256::Sigma0(int *z, int *x)
+void SHA256::Sigma0(Formula &cnf, int *z, int *x)
 {
     int r1[32], r2[32], r3[32];
     cnf.rotr(r1, x, 2);
@@ -134,7 +136,7 @@ void SHA256::Sigma0(int *z, int *x)
     cnf.xor3(z, r1, r2, r3);
 }
 
-void SHA256::Sigma1(int *z, int *x)
+void SHA256::Sigma1(Formula &cnf, int *z, int *x)
 {
     int r1[32], r2[32], r3[32];
     cnf.rotr(r1, x, 6);
@@ -21,11 +21,12 @@ class SHA256 {
 
         int rounds;
         bool initialBlock;
+        int threads;                                                            // for building the message expansion and the rounds
 
         Formula cnf;
 
-        void Sigma0(int *z, int *x);
-        void Sigma1(int *z, int *x);
+        void Sigma0(Formula &cnf, int *z, int *x);
+        void Sigma1(Formula &cnf, int *z, int *x);
 };
 
 #endif
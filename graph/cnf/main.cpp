@@ -0,0 +1,204 @@
+/*
+ * Structural features of a DIMACS formula in one pass over the file.
+ *
+ * Builds the primal graph (variables, adjacent when they share a clause;
+ * a clause of size k adds weight 1/(k choose 2) to each of its pairs, as in
+ * the community structure literature) and the incidence graph (variables and
+ * clauses, bipartite), then reports their Louvain modularity and heuristic
+ * treewidth bounds.
+ */
+
+#include "graph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <thread>
+
+/* config options */
+int cfg_threads;
+int cfg_max_clause;
+int cfg_no_width;
+int cfg_no_incidence;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options] {input.cnf}\n"
+            "  --help or -h                             Prints this message\n"
+            "  --threads or -j {int}                    Threads used by Louvain (default: all cores)\n"
+            "  --max_clause {int}                       Clauses longer than int are left out of the primal graph (default: no limit)\n"
+            "  --no_width                               Skips the treewidth bounds\n"
+            "  --no_incidence                           Skips the incidence graph\n"
+          );
+}
+
+/* reads the next integer, skipping comment lines and the header; false on EOF */
+static bool readLit(FILE *f, int &x, int &vars, int &clauses)
+{
+    int c;
+    while( true )
+    {
+        c = getc_unlocked(f);
+        if ( c == EOF ) return false;
+        if ( c == 'c' || c == 'p' )
+        {
+            if ( c == 'p' && fscanf(f, " cnf %d %d", &vars, &clauses) != 2 )
+                fprintf(stderr, "bad DIMACS header\n");
+            while( (c = getc_unlocked(f)) != EOF && c != '\n' );
+            continue;
+        }
+        if ( c == '-' || (c >= '0' && c <= '9') ) break;
+    }
+
+    bool neg = c == '-';
+    if ( neg ) c = getc_unlocked(f);
+    x = 0;
+    while( c >= '0' && c <= '9' )
+    {
+        x = x * 10 + (c - '0');
+        c = getc_unlocked(f);
+    }
+    if ( neg ) x = -x;
+    return true;
+}
+
+static void report(const char *name, const Graph &g)
+{
+    vector<int> comm;
+    double q = g.louvain(comm, cfg_threads);
+    int nc = 0;
+    for( int c : comm )
+        nc = max(nc, c + 1);
+
+    printf("%s_vertices %d\n", name, g.getVertexCnt());
+    printf("%s_edges %ld\n", name, g.getEdgeCnt());
+    printf("%s_modularity %.6f\n", name, q);
+    printf("%s_communities %d\n", name, nc);
+
+    if ( !cfg_no_width )
+    {
+        vector<int> order;
+        printf("%s_width_lb %d\n", name, g.degeneracy());
+        printf("%s_width_ub %d\n", name, g.minDegreeOrder(order));
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    /* Arguments default values */
+    cfg_threads = thread::hardware_concurrency();
+    cfg_max_clause = 0;
+    cfg_no_width = 0;
+    cfg_no_incidence = 0;
+
+    struct option long_options[] =
+    {
+        /* flag options */
+        {"no_width",     no_argument, &cfg_no_width,     1},
+        {"no_incidence", no_argument, &cfg_no_incidence, 1},
+        /* valued options */
+        {"threads",    required_argument, 0, 'j'},
+        {"max_clause", required_argument, 0, 'm'},
+        {"help",       no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "j:h", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 0:
+                break;
+
+            case 'j':
+                cfg_threads = atoi(optarg);
+                break;
+
+            case 'm':
+                cfg_max_clause = atoi(optarg);
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
+
+            default:
+                abort ();
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        display_usage();
+        return 1;
+    }
+    if ( cfg_threads < 1 ) cfg_threads = 1;
+
+    FILE *f = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+    if ( !f )
+    {
+        fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 1;
+    }
+
+    /* Stream the clauses into the edge lists of both graphs */
+    int vars = 0, clauses = 0, lit, cnt = 0, maxVar = 0;
+    vector<int> cl;
+    vector<pair<int, int>> primal, incidence;
+    vector<double> pw;
+    while( readLit(f, lit, vars, clauses) )
+    {
+        if ( lit != 0 )
+        {
+            cl.push_back(abs(lit) - 1);
+            maxVar = max(maxVar, abs(lit));
+            continue;
+        }
+
+        int k = cl.size();
+        if ( k >= 2 && (cfg_max_clause == 0 || k <= cfg_max_clause) )
+        {
+            double w = 2.0 / (k * (k - 1.0));
+            for( int i=0; i<k; i++ )
+                for( int j=i+1; j<k; j++ )
+                {
+                    primal.push_back(make_pair(cl[i], cl[j]));
+                    pw.push_back(w);
+                }
+        }
+        if ( !cfg_no_incidence )
+            for( int v : cl )
+                incidence.push_back(make_pair(v, -(cnt + 1)));
+
+        cnt++;
+        cl.clear();
+    }
+    if ( f != stdin ) fclose(f);
+
+    vars = max(vars, maxVar);
+    printf("vars %d\n", vars);
+    printf("clauses %d\n", cnt);
+
+    Graph g;
+    g.build(vars, primal, &pw);
+    vector<pair<int, int>>().swap(primal);
+    vector<double>().swap(pw);
+    report("primal", g);
+
+    if ( !cfg_no_incidence )
+    {
+        /* clause 'i' is vertex 'vars + i' */
+        for( auto &e : incidence )
+            e.second = vars - e.second - 1;
+        Graph h;
+        h.build(vars + cnt, incidence);
+        report("incidence", h);
+    }
+
+    return 0;
+}
@@ -0,0 +1,1049 @@
+#include "graph.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* reads the next (possibly negative) integer, returns false on EOF */
+static bool readInt(FILE *f, long &x)
+{
+    int c = getc_unlocked(f);
+    while( c != EOF && c != '-' && (c < '0' || c > '9') )
+        c = getc_unlocked(f);
+    if ( c == EOF ) return false;
+
+    bool neg = false;
+    if ( c == '-' ) { neg = true; c = getc_unlocked(f); }
+
+    x = 0;
+    while( c >= '0' && c <= '9' )
+    {
+        x = x * 10 + (c - '0');
+        c = getc_unlocked(f);
+    }
+    if ( neg ) x = -x;
+    return true;
+}
+
+/* skips the rest of the current line */
+static void skipLine(FILE *f)
+{
+    int c;
+    while( (c = getc_unlocked(f)) != EOF && c != '\n' );
+}
+
+Graph::Graph()
+{
+    n = 0;
+    offset.push_back(0);
+}
+
+Graph::~Graph()
+{
+}
+
+void Graph::build(int nv, vector<pair<int, int>> &edges, const vector<double> *weights)
+{
+    n = nv;
+    bool weighted = weights != NULL;
+
+    vector<int> idx(edges.size());
+    for( size_t i=0; i<edges.size(); i++ )
+    {
+        if ( edges[i].first > edges[i].second ) swap(edges[i].first, edges[i].second);
+        idx[i] = i;
+    }
+    sort(idx.begin(), idx.end(), [&](int a, int b){ return edges[a] < edges[b]; });
+
+    /* merge parallel edges and drop self loops */
+    vector<pair<int, int>> e;
+    vector<double> w;
+    for( int i : idx )
+    {
+        if ( edges[i].first == edges[i].second ) continue;
+        if ( !e.empty() && e.back() == edges[i] )
+        {
+            if ( weighted ) w.back() += (*weights)[i];
+            continue;
+        }
+        e.push_back(edges[i]);
+        if ( weighted ) w.push_back((*weights)[i]);
+    }
+
+    offset.assign(n + 1, 0);
+    for( auto &p : e )
+    {
+        offset[p.first + 1]++;
+        offset[p.second + 1]++;
+    }
+    for( int v=0; v<n; v++ )
+        offset[v+1] += offset[v];
+
+    adj.resize(2 * e.size());
+    weight.clear();
+    if ( weighted ) weight.resize(2 * e.size());
+
+    vector<int> pos(offset.begin(), offset.end() - 1);
+    for( size_t i=0; i<e.size(); i++ )
+    {
+        int u = e[i].first, v = e[i].second;
+        if ( weighted ) { weight[pos[u]] = w[i]; weight[pos[v]] = w[i]; }
+        adj[pos[u]++] = v;
+        adj[pos[v]++] = u;
+    }
+}
+
+bool Graph::readGR(FILE *f)
+{
+    int nv = -1;
+    vector<pair<int, int>> edges;
+
+    int c;
+    while( (c = getc_unlocked(f)) != EOF )
+    {
+        if ( c == 'c' ) { skipLine(f); continue; }
+        if ( c == 'p' )
+        {
+            char fmt[16];
+            long m;
+            if ( fscanf(f, "%15s %d %ld", fmt, &nv, &m) != 3 || strcmp(fmt, "tw") != 0 )
+            {
+                fprintf(stderr, "bad .gr header\n");
+                return false;
+            }
+            edges.reserve(m);
+            continue;
+        }
+        if ( c >= '0' && c <= '9' )
+        {
+            ungetc(c, f);
+            long u, v;
+            if ( !readInt(f, u) || !readInt(f, v) || nv < 0 )
+            {
+                fprintf(stderr, "bad .gr edge\n");
+                return false;
+            }
+            if ( u < 1 || v < 1 || u > nv || v > nv )
+            {
+                fprintf(stderr, "bad .gr edge: %ld %ld (%d vertices)\n", u, v, nv);
+                return false;
+            }
+            edges.push_back(make_pair(u - 1, v - 1));
+        }
+    }
+
+    if ( nv < 0 ) { fprintf(stderr, "missing .gr header\n"); return false; }
+    build(nv, edges);
+    return true;
+}
+
+bool Graph::readGR(const string &path)
+{
+    FILE *f = path == "-" ? stdin : fopen(path.c_str(), "r");
+    if ( !f ) { fprintf(stderr, "cannot open %s\n", path.c_str()); return false; }
+    bool ok = readGR(f);
+    if ( f != stdin ) fclose(f);
+    return ok;
+}
+
+void Graph::writeGR(FILE *f) const
+{
+    fprintf(f, "p tw %d %ld\n", n, getEdgeCnt());
+    for( int v=0; v<n; v++ )
+        for( int i=offset[v]; i<offset[v+1]; i++ )
+            if ( v < adj[i] )
+                fprintf(f, "%d %d\n", v + 1, adj[i] + 1);
+}
+
+int Graph::components(vector<int> &comp) const
+{
+    comp.assign(n, -1);
+    vector<int> q(n);
+    int cnt = 0;
+
+    for( int s=0; s<n; s++ )
+    {
+        if ( comp[s] != -1 ) continue;
+        int head = 0, tail = 0;
+        q[tail++] = s;
+        comp[s] = cnt;
+        while( head < tail )
+        {
+            int v = q[head++];
+            for( int i=offset[v]; i<offset[v+1]; i++ )
+                if ( comp[adj[i]] == -1 )
+                {
+                    comp[adj[i]] = cnt;
+                    q[tail++] = adj[i];
+                }
+        }
+        cnt++;
+    }
+    return cnt;
+}
+
+int Graph::blocks(vector<vector<int>> &blk) const
+{
+    /* iterative Hopcroft-Tarjan */
+    vector<int> disc(n, -1), low(n), parent(n, -1), it(n);
+    vector<int> dfs, st;
+    int t = 0;
+
+    blk.clear();
+    for( int s=0; s<n; s++ )
+    {
+        if ( disc[s] != -1 ) continue;
+        if ( degree(s) == 0 )
+        {
+            disc[s] = t++;
+            blk.push_back(vector<int>(1, s));
+            continue;
+        }
+
+        disc[s] = low[s] = t++;
+        it[s] = offset[s];
+        st.push_back(s);
+        dfs.push_back(s);
+
+        while( !dfs.empty() )
+        {
+            int v = dfs.back();
+            if ( it[v] < offset[v+1] )
+            {
+                int u = adj[it[v]++];
+                if ( disc[u] == -1 )
+                {
+                    parent[u] = v;
+                    disc[u] = low[u] = t++;
+                    it[u] = offset[u];
+                    st.push_back(u);
+                    dfs.push_back(u);
+                }
+                else if ( u != parent[v] )
+                    low[v] = min(low[v], disc[u]);
+                continue;
+            }
+
+            dfs.pop_back();
+            int p = parent[v];
+            if ( p == -1 ) continue;
+
+            low[p] = min(low[p], low[v]);
+            if ( low[v] >= disc[p] )
+            {
+                vector<int> b;
+                int x;
+                do {
+                    x = st.back();
+                    st.pop_back();
+                    b.push_back(x);
+                } while( x != v );
+                b.push_back(p);
+                blk.push_back(b);
+            }
+        }
+        st.clear();
+    }
+    return blk.size();
+}
+
+Graph Graph::induced(const vector<int> &vertices) const
+{
+    unordered_map<int, int> local;
+    local.reserve(2 * vertices.size());
+    for( size_t i=0; i<vertices.size(); i++ )
+        local[vertices[i]] = i;
+
+    vector<pair<int, int>> edges;
+    vector<double> w;
+    for( size_t i=0; i<vertices.size(); i++ )
+    {
+        int v = vertices[i];
+        for( int j=offset[v]; j<offset[v+1]; j++ )
+        {
+            auto e = local.find(adj[j]);
+            if ( e == local.end() || e->second <= (int)i ) continue;
+            edges.push_back(make_pair(i, e->second));
+            if ( isWeighted() ) w.push_back(weight[j]);
+        }
+    }
+
+    Graph g;
+    g.build(vertices.size(), edges, isWeighted() ? &w : NULL);
+    return g;
+}
+
+Graph Graph::range(int lo, int hi) const
+{
+    vector<pair<int, int>> edges;
+    vector<double> w;
+    for( int v=lo; v<hi; v++ )
+        for( int j=offset[v]; j<offset[v+1]; j++ )
+        {
+            if ( adj[j] <= v || adj[j] >= hi ) continue;
+            edges.push_back(make_pair(v - lo, adj[j] - lo));
+            if ( isWeighted() ) w.push_back(weight[j]);
+        }
+
+    Graph g;
+    g.build(hi - lo, edges, isWeighted() ? &w : NULL);
+    return g;
+}
+
+/* adds the sorted list 'b' (minus 'skip1' and 'skip2') into the sorted list 'a' */
+static void mergeInto(vector<int> &a, const vector<int> &b, int skip1, int skip2)
+{
+    vector<int> r;
+    r.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while( i < a.size() || j < b.size() )
+    {
+        int x;
+        if ( j == b.size() || (i < a.size() && a[i] < b[j]) ) x = a[i++];
+        else if ( i == a.size() || b[j] < a[i] ) x = b[j++];
+        else { x = a[i++]; j++; }
+        if ( x != skip1 && x != skip2 ) r.push_back(x);
+    }
+    a.swap(r);
+}
+
+/*
+ * Greedy min-degree elimination of the vertices 'v' with !done[v], on the
+ * elimination graph given by their sorted neighbourhoods 'nb' (which is used
+ * up). Appends them to 'order', stores their bags in 'bags' if given and
+ * returns the width.
+ */
+static int minDegreeGreedy(vector<vector<int>> &nb, vector<char> &done, vector<int> &order, vector<vector<int>> *bags)
+{
+    typedef pair<int, int> DV;
+    priority_queue<DV, vector<DV>, greater<DV>> pq;
+    for( size_t v=0; v<nb.size(); v++ )
+        if ( !done[v] )
+            pq.push(DV(nb[v].size(), v));
+
+    int width = 0;
+    while( !pq.empty() )
+    {
+        DV top = pq.top(); pq.pop();
+        int v = top.second;
+        if ( done[v] || top.first != (int)nb[v].size() ) continue;
+
+        done[v] = 1;
+        order.push_back(v);
+        width = max(width, (int)nb[v].size());
+
+        for( int u : nb[v] )
+        {
+            mergeInto(nb[u], nb[v], u, v);
+            pq.push(DV(nb[u].size(), u));
+        }
+        if ( bags ) (*bags)[v].swap(nb[v]);
+        vector<int>().swap(nb[v]);
+    }
+    return width;
+}
+
+int Graph::minDegreeOrder(vector<int> &order) const
+{
+    vector<vector<int>> nb(n);
+    for( int v=0; v<n; v++ )
+    {
+        nb[v].assign(adj.begin() + offset[v], adj.begin() + offset[v+1]);
+        sort(nb[v].begin(), nb[v].end());
+    }
+
+    vector<char> done(n, 0);
+    order.clear();
+    return minDegreeGreedy(nb, done, order, NULL);
+}
+
+/* number of missing edges among the neighbourhood of 'v' */
+static long fillIn(const vector<vector<int>> &nb, int v)
+{
+    long fill = 0;
+    const vector<int> &a = nb[v];
+    for( size_t i=0; i<a.size(); i++ )
+        for( size_t j=i+1; j<a.size(); j++ )
+            if ( !binary_search(nb[a[i]].begin(), nb[a[i]].end(), a[j]) )
+                fill++;
+    return fill;
+}
+
+int Graph::minFillOrder(vector<int> &order) const
+{
+    vector<vector<int>> nb(n);
+    for( int v=0; v<n; v++ )
+    {
+        nb[v].assign(adj.begin() + offset[v], adj.begin() + offset[v+1]);
+        sort(nb[v].begin(), nb[v].end());
+    }
+
+    /* (fill, degree, v) with lazy deletion through 'stamp' */
+    typedef pair<pair<long, int>, int> FV;
+    priority_queue<FV, vector<FV>, greater<FV>> pq;
+    vector<long> fill(n);
+    for( int v=0; v<n; v++ )
+    {
+        fill[v] = fillIn(nb, v);
+        pq.push(FV(make_pair(fill[v], nb[v].size()), v));
+    }
+
+    vector<char> done(n, 0);
+    vector<int> mark(n, -1);
+    order.clear();
+    int width = 0;
+
+    while( !pq.empty() )
+    {
+        FV top = pq.top(); pq.pop();
+        int v = top.second;
+        if ( done[v] || top.first.first != fill[v] || top.first.second != (int)nb[v].size() ) continue;
+
+        done[v] = 1;
+        order.push_back(v);
+        width = max(width, (int)nb[v].size());
+
+        for( int u : nb[v] )
+            mergeInto(nb[u], nb[v], u, v);
+
+        /* fill values change for the neighbourhood and its neighbours */
+        vector<int> touched;
+        for( int u : nb[v] )
+        {
+            if ( mark[u] != v ) { mark[u] = v; touched.push_back(u); }
+            for( int w : nb[u] )
+                if ( mark[w] != v ) { mark[w] = v; touched.push_back(w); }
+        }
+        vector<int>().swap(nb[v]);
+
+        for( int u : touched )
+        {
+            fill[u] = fillIn(nb, u);
+            pq.push(FV(make_pair(fill[u], nb[u].size()), u));
+        }
+    }
+    return width;
+}
+
+int Graph::eliminationWidth(const vector<int> &order, vector<vector<int>> *bags, vector<int> *parent) const
+{
+    vector<int> pos(n);
+    for( int i=0; i<n; i++ )
+        pos[order[i]] = i;
+
+    /* fill-in computation (Tarjan & Yannakakis): the higher neighbourhood of 'v'
+     * is passed on to its lowest higher neighbour only */
+    vector<vector<int>> up(n);
+    for( int v=0; v<n; v++ )
+        for( int i=offset[v]; i<offset[v+1]; i++ )
+            if ( pos[adj[i]] > pos[v] )
+                up[v].push_back(adj[i]);
+
+    if ( bags ) bags->assign(n, vector<int>());
+    if ( parent ) parent->assign(n, -1);
+
+    vector<int> mark(n, -1);
+    int width = 0;
+    for( int i=0; i<n; i++ )
+    {
+        int v = order[i];
+        vector<int> nb;
+        int m = -1;
+        for( int u : up[v] )
+        {
+            if ( mark[u] == v ) continue;
+            mark[u] = v;
+            nb.push_back(u);
+            if ( m == -1 || pos[u] < pos[m] ) m = u;
+        }
+        vector<int>().swap(up[v]);
+        width = max(width, (int)nb.size());
+
+        if ( m != -1 )
+            for( int u : nb )
+                if ( u != m ) up[m].push_back(u);
+
+        if ( bags )
+        {
+            (*bags)[v] = nb;
+            (*bags)[v].push_back(v);
+        }
+        if ( parent ) (*parent)[v] = m;
+    }
+    return width;
+}
+
+int Graph::degeneracy() const
+{
+    vector<int> deg(n);
+    typedef pair<int, int> DV;
+    priority_queue<DV, vector<DV>, greater<DV>> pq;
+    for( int v=0; v<n; v++ )
+    {
+        deg[v] = degree(v);
+        pq.push(DV(deg[v], v));
+    }
+
+    vector<char> done(n, 0);
+    int k = 0;
+    while( !pq.empty() )
+    {
+        DV top = pq.top(); pq.pop();
+        int v = top.second;
+        if ( done[v] || top.first != deg[v] ) continue;
+        done[v] = 1;
+        k = max(k, deg[v]);
+        for( int i=offset[v]; i<offset[v+1]; i++ )
+            if ( !done[adj[i]] )
+                pq.push(DV(--deg[adj[i]], adj[i]));
+    }
+    return k;
+}
+
+double Graph::modularity(const vector<int> &comm) const
+{
+    int nc = 0;
+    for( int c : comm )
+        nc = max(nc, c + 1);
+
+    vector<double> in(nc, 0), tot(nc, 0);
+    double m2 = 0;
+    for( int v=0; v<n; v++ )
+        for( int i=offset[v]; i<offset[v+1]; i++ )
+        {
+            double w = isWeighted() ? weight[i] : 1;
+            m2 += w;
+            tot[comm[v]] += w;
+            if ( comm[adj[i]] == comm[v] ) in[comm[v]] += w;
+        }
+    if ( m2 == 0 ) return 0;
+
+    double q = 0;
+    for( int c=0; c<nc; c++ )
+        q += in[c] / m2 - (tot[c] / m2) * (tot[c] / m2);
+    return q;
+}
+
+/*
+ * One level of Louvain on a weighted graph with self loops ('loop[v]' is the
+ * weight inside the aggregated vertex 'v'). Vertices are processed one color
+ * class of a greedy coloring at a time: the moves of a class are evaluated in
+ * parallel against the same community totals, which is safe since no two of
+ * them are adjacent, and then applied.
+ */
+static bool louvainLevel(const Graph &g, const vector<double> &loop, vector<int> &comm, int threads)
+{
+    int n = g.n;
+    vector<double> k(n);
+    double m2 = 0;
+    for( int v=0; v<n; v++ )
+    {
+        k[v] = 2 * loop[v];
+        for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+            k[v] += g.weight[i];
+        m2 += k[v];
+    }
+    if ( m2 == 0 ) return false;
+
+    /* greedy coloring */
+    vector<int> color(n, -1), used;
+    int ncolors = 0;
+    for( int v=0; v<n; v++ )
+    {
+        used.assign(ncolors + 1, 0);
+        for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+            if ( color[g.adj[i]] != -1 )
+                used[color[g.adj[i]]] = 1;
+        int c = 0;
+        while( used[c] ) c++;
+        color[v] = c;
+        ncolors = max(ncolors, c + 1);
+    }
+    vector<vector<int>> classes(ncolors);
+    for( int v=0; v<n; v++ )
+        classes[color[v]].push_back(v);
+
+    comm.resize(n);
+    vector<double> tot(n);
+    for( int v=0; v<n; v++ )
+    {
+        comm[v] = v;
+        tot[v] = k[v];
+    }
+
+    /* a thread per 1024 vertices of a class, and an accumulator per thread started */
+    auto threadsFor = [threads](const vector<int> &cls) { return (int)min<long>(threads, cls.size() / 1024 + 1); };
+    int started = 1;
+    for( vector<int> &cls : classes )
+        started = max(started, threadsFor(cls));
+
+    vector<int> target(n);
+    vector<double> delta(n);
+    vector<vector<double>> scratch(started, vector<double>(n, 0));
+    auto evaluate = [&](const vector<int> &cls, size_t from, size_t to, int t)
+    {
+        vector<double> &acc = scratch[t];
+        vector<int> touched;
+        for( size_t j=from; j<to; j++ )
+        {
+            int v = cls[j], own = comm[v];
+            touched.clear();
+            acc[own] = 0;
+            touched.push_back(own);
+            for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+            {
+                int c = comm[g.adj[i]];
+                if ( acc[c] == 0 && c != own ) touched.push_back(c);
+                acc[c] += g.weight[i];
+            }
+
+            /* gain of joining 'c' after leaving 'own' */
+            int best = own;
+            double stay = acc[own] - (tot[own] - k[v]) * k[v] / m2, bestGain = stay;
+            for( int c : touched )
+            {
+                double gain = acc[c] - tot[c] * k[v] / m2;
+                if ( c != own && gain > bestGain )
+                {
+                    best = c;
+                    bestGain = gain;
+                }
+            }
+            target[v] = best;
+            delta[v] = bestGain - stay;
+
+            for( int c : touched )
+                acc[c] = 0;
+        }
+    };
+
+    bool improved = false;
+    for( int pass=0; pass<32; pass++ )
+    {
+        long moves = 0;
+        double gain = 0;
+        for( vector<int> &cls : classes )
+        {
+            int nt = threadsFor(cls);
+            vector<thread> workers;
+            size_t chunk = (cls.size() + nt - 1) / nt;
+            for( int t=1; t<nt; t++ )
+                workers.push_back(thread(evaluate, cref(cls), min(t * chunk, cls.size()), min((t + 1) * chunk, cls.size()), t));
+            evaluate(cls, 0, min(chunk, cls.size()), 0);
+            for( thread &t : workers )
+                t.join();
+
+            for( int v : cls )
+            {
+                if ( target[v] == comm[v] ) continue;
+                tot[comm[v]] -= k[v];
+                tot[target[v]] += k[v];
+                comm[v] = target[v];
+                gain += delta[v];
+                moves++;
+            }
+        }
+        if ( moves == 0 ) break;
+        improved = true;
+
+        /* estimated modularity gain of the pass */
+        if ( 2 * gain / m2 < 1e-5 ) break;
+    }
+    return improved;
+}
+
+double Graph::louvain(vector<int> &comm, int threads) const
+{
+    /* unit weights for unweighted graphs */
+    Graph g = *this;
+    if ( !g.isWeighted() ) g.weight.assign(g.adj.size(), 1.0);
+    vector<double> loop(n, 0);
+
+    comm.resize(n);
+    for( int v=0; v<n; v++ )
+        comm[v] = v;
+
+    while( true )
+    {
+        vector<int> level;
+        if ( !louvainLevel(g, loop, level, max(threads, 1)) ) break;
+
+        /* renumber the communities */
+        vector<int> id(g.n, -1);
+        int nc = 0;
+        for( int v=0; v<g.n; v++ )
+            if ( id[level[v]] == -1 ) id[level[v]] = nc++;
+        for( int v=0; v<n; v++ )
+            comm[v] = id[level[comm[v]]];
+        if ( nc == g.n ) break;
+
+        /* aggregate */
+        vector<pair<int, int>> edges;
+        vector<double> w;
+        vector<double> nloop(nc, 0);
+        for( int v=0; v<g.n; v++ )
+        {
+            int cv = id[level[v]];
+            nloop[cv] += loop[v];
+            for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+            {
+                int u = g.adj[i];
+                if ( u < v ) continue;
+                int cu = id[level[u]];
+                if ( cu == cv ) nloop[cv] += g.weight[i];
+                else
+                {
+                    edges.push_back(make_pair(cv, cu));
+                    w.push_back(g.weight[i]);
+                }
+            }
+        }
+        Graph next;
+        next.build(nc, edges, &w);
+        g = next;
+        loop.swap(nloop);
+    }
+
+    return modularity(comm);
+}
+
+MinDegreeWindow::MinDegreeWindow(const Graph &graph) :
+    g(graph), lo(0), hi(0), bags(graph.n), cliques(graph.n), clean(graph.n, 0), mark(graph.n, 0), cleanCnt(0)
+{
+}
+
+void MinDegreeWindow::setClean(int v, bool c)
+{
+    clean[v] = c;
+    for( int u : bags[v] )
+    {
+        vector<int> &cl = cliques[u];
+        if ( c ) cl.push_back(v);
+        else
+        {
+            *find(cl.begin(), cl.end(), v) = cl.back();
+            cl.pop_back();
+        }
+    }
+}
+
+int MinDegreeWindow::advance(int newLo, int newHi, bool refresh)
+{
+    /* Clean vertices of the previous ordering, in their old order */
+    vector<int> keep;
+    if ( !refresh )
+    {
+        for( int v=max(hi, newLo); v<newHi; v++ )
+            for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+                if ( g.adj[i] >= newLo && g.adj[i] < newHi )
+                    mark[g.adj[i]] = 1;
+
+        for( int v : order )
+        {
+            bool ok = !mark[v] && v >= newLo;
+            for( int u : bags[v] )
+                if ( u < newLo ) ok = false;
+
+            if ( ok ) keep.push_back(v);
+            else
+                for( int u : bags[v] )
+                    mark[u] = 1;
+        }
+        fill(mark.begin() + min(lo, newLo), mark.begin() + newHi, 0);
+    }
+
+    /* Update the clean set; the leaving vertices are in no clean bag */
+    for( int v : keep )
+        mark[v] = 1;
+    for( int v : order )
+        if ( clean[v] && !mark[v] )
+            setClean(v, false);
+    for( int v : keep )
+    {
+        mark[v] = 0;
+        if ( !clean[v] )
+            setClean(v, true);
+    }
+    for( int v=lo; v<min(hi, newLo); v++ )
+        vector<int>().swap(bags[v]);
+    lo = newLo;
+    hi = newHi;
+
+    /* Greedy choice on the elimination graph of the rest of the window */
+    int n = hi - lo, width = 0;
+    vector<vector<int>> nb(n), nbBags(n);
+    vector<char> done(n, 0);
+    for( int v=lo; v<hi; v++ )
+    {
+        if ( clean[v] )
+        {
+            done[v - lo] = 1;
+            width = max(width, (int)bags[v].size());
+            continue;
+        }
+
+        vector<int> &a = nb[v - lo];
+        mark[v] = 1;
+        for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+        {
+            int u = g.adj[i];
+            if ( u >= lo && u < hi && !clean[u] && !mark[u] ) { mark[u] = 1; a.push_back(u); }
+        }
+        for( int c : cliques[v] )
+            for( int u : bags[c] )
+                if ( !clean[u] && !mark[u] ) { mark[u] = 1; a.push_back(u); }
+        mark[v] = 0;
+        for( int &u : a )
+        {
+            mark[u] = 0;
+            u -= lo;
+        }
+        sort(a.begin(), a.end());
+    }
+
+    vector<int> local;
+    width = max(width, minDegreeGreedy(nb, done, local, &nbBags));
+
+    order.swap(keep);
+    for( int v : local )
+    {
+        for( int &u : nbBags[v] )
+            u += lo;
+        bags[v + lo].swap(nbBags[v]);
+        order.push_back(v + lo);
+    }
+    cleanCnt = n - local.size();
+    return width;
+}
+
+TreeDecomposition::TreeDecomposition()
+{
+    vertices = 0;
+}
+
+int TreeDecomposition::getWidth() const
+{
+    int w = 0;
+    for( auto &b : bags )
+        w = max(w, (int)b.size());
+    return w - 1;
+}
+
+int TreeDecomposition::findBag(int v) const
+{
+    for( size_t i=0; i<bags.size(); i++ )
+        if ( find(bags[i].begin(), bags[i].end(), v) != bags[i].end() )
+            return i;
+    return -1;
+}
+
+void TreeDecomposition::fromElimination(const Graph &g, const vector<int> &order)
+{
+    vector<int> parent;
+    g.eliminationWidth(order, &bags, &parent);
+    vertices = g.n;
+    edges.clear();
+
+    /* bag 'v' belongs to the vertex 'v'; roots of the forest are chained together */
+    int root = -1;
+    for( int v : order )
+    {
+        if ( parent[v] != -1 )
+            edges.push_back(make_pair(v, parent[v]));
+        else
+        {
+            if ( root != -1 ) edges.push_back(make_pair(root, v));
+            root = v;
+        }
+    }
+
+    if ( bags.empty() ) bags.push_back(vector<int>());
+}
+
+bool TreeDecomposition::read(FILE *f)
+{
+    bags.clear();
+    edges.clear();
+
+    char *line = NULL;
+    size_t cap = 0;
+    int nbags = -1;
+    while( getline(&line, &cap, f) != -1 )
+    {
+        if ( line[0] == 'c' || line[0] == '\n' ) continue;
+        if ( line[0] == 's' )
+        {
+            int w;
+            if ( sscanf(line, "s td %d %d %d", &nbags, &w, &vertices) != 3 ) break;
+            bags.resize(nbags);
+            continue;
+        }
+
+        char *p = line, *q;
+        if ( line[0] == 'b' )
+        {
+            p++;
+            long id = strtol(p, &q, 10);
+            if ( q == p || id < 1 || id > nbags ) break;
+            p = q;
+            while( true )
+            {
+                long v = strtol(p, &q, 10);
+                if ( q == p ) break;
+                bags[id-1].push_back(v - 1);
+                p = q;
+            }
+            continue;
+        }
+
+        long a = strtol(p, &q, 10);
+        if ( q == p ) continue;
+        long b = strtol(q, &p, 10);
+        if ( p == q || a < 1 || b < 1 || a > nbags || b > nbags ) break;
+        edges.push_back(make_pair(a - 1, b - 1));
+    }
+    free(line);
+
+    if ( nbags < 0 ) return false;
+    return true;
+}
+
+bool TreeDecomposition::read(const string &path)
+{
+    FILE *f = fopen(path.c_str(), "r");
+    if ( !f ) return false;
+    bool ok = read(f);
+    fclose(f);
+    return ok;
+}
+
+void TreeDecomposition::write(FILE *f) const
+{
+    fprintf(f, "s td %d %d %d\n", getBagCnt(), getWidth() + 1, vertices);
+    for( size_t i=0; i<bags.size(); i++ )
+    {
+        fprintf(f, "b %zu", i + 1);
+        for( int v : bags[i] )
+            fprintf(f, " %d", v + 1);
+        fprintf(f, "\n");
+    }
+    for( auto &e : edges )
+        fprintf(f, "%d %d\n", e.first + 1, e.second + 1);
+}
+
+void TreeDecomposition::relabel(const vector<int> &map)
+{
+    for( auto &b : bags )
+        for( int &v : b )
+            v = map[v];
+}
+
+int TreeDecomposition::append(const TreeDecomposition &td)
+{
+    int base = bags.size();
+    bags.insert(bags.end(), td.bags.begin(), td.bags.end());
+    for( auto &e : td.edges )
+        edges.push_back(make_pair(e.first + base, e.second + base));
+    return base;
+}
+
+bool TreeDecomposition::valid(const Graph &g) const
+{
+    int nb = bags.size();
+    if ( (int)edges.size() != nb - 1 ) return false;
+
+    /* the bags must form a tree */
+    vector<vector<int>> tree(nb);
+    for( auto &e : edges )
+    {
+        tree[e.first].push_back(e.second);
+        tree[e.second].push_back(e.first);
+    }
+    vector<char> seen(nb, 0);
+    vector<int> q(1, 0);
+    seen[0] = 1;
+    for( size_t i=0; i<q.size(); i++ )
+        for( int c : tree[q[i]] )
+            if ( !seen[c] ) { seen[c] = 1; q.push_back(c); }
+    if ( (int)q.size() != nb ) return false;
+
+    /* every vertex occurs and its bags are connected */
+    vector<int> occ(g.n, 0), links(g.n, 0);
+    vector<vector<char>> in(nb);
+    for( int i=0; i<nb; i++ )
+        for( int v : bags[i] )
+            occ[v]++;
+    for( auto &e : edges )
+    {
+        vector<int> a = bags[e.first], b = bags[e.second];
+        sort(a.begin(), a.end());
+        sort(b.begin(), b.end());
+        vector<int> c;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(c));
+        for( int v : c ) links[v]++;
+    }
+    for( int v=0; v<g.n; v++ )
+        if ( occ[v] == 0 || links[v] != occ[v] - 1 ) return false;
+
+    /* every edge is covered */
+    vector<vector<int>> where(g.n);
+    for( int i=0; i<nb; i++ )
+        for( int v : bags[i] )
+            where[v].push_back(i);
+    for( int v=0; v<g.n; v++ )
+        for( int i=g.offset[v]; i<g.offset[v+1]; i++ )
+        {
+            int u = g.adj[i];
+            if ( u < v ) continue;
+            bool covered = false;
+            for( int b : where[v] )
+                if ( find(bags[b].begin(), bags[b].end(), u) != bags[b].end() ) { covered = true; break; }
+            if ( !covered ) return false;
+        }
+    return true;
+}
+
+TreewidthEngine::TreewidthEngine(Heuristic h, string s)
+{
+    heuristic = h;
+    solver = s;
+    const char *tmp = getenv("TMPDIR");
+    tmpDir = tmp ? tmp : "/tmp";
+}
+
+void TreewidthEngine::decompose(const Graph &g, TreeDecomposition &td, int threshold) const
+{
+    if ( solver != "" && g.n > threshold )
+    {
+        string in = tmpDir + "/twXXXXXX";
+        vector<char> buf(in.begin(), in.end());
+        buf.push_back(0);
+        int fd = mkstemp(&buf[0]);
+        if ( fd != -1 )
+        {
+            in = &buf[0];
+            string out = in + ".td";
+            FILE *f = fdopen(fd, "w");
+            g.writeGR(f);
+            fclose(f);
+
+            string cmd = solver + " " + in + " > " + out;
+            int status = system(cmd.c_str());
+            bool ok = status == 0 && td.read(out) && td.vertices == g.n && td.getBagCnt() > 0;
+            unlink(in.c_str());
+            unlink(out.c_str());
+            if ( ok ) return;
+
+            fprintf(stderr, "c treewidth solver failed on a %d vertex graph, using heuristic\n", g.n);
+        }
+    }
+
+    vector<int> order;
+    if ( heuristic == MIN_FILL ) g.minFillOrder(order);
+    else g.minDegreeOrder(order);
+    td.fromElimination(g, order);
+}
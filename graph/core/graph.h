@@ -0,0 +1,143 @@
+#ifndef _GRAPH_H_
+#define _GRAPH_H_
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdio.h>
+
+using namespace std;
+
+/*
+ * Undirected simple graph in compressed sparse row (CSR) form.
+ *
+ * Vertices are numbered 0..n-1 internally; vertex 'v' of a .gr file
+ * (PACE format, 1-based) is stored as 'v-1'. Edge weights are optional
+ * and only kept when the graph is built with a weight vector.
+ */
+class Graph
+{
+    public:
+        Graph();
+        virtual ~Graph();
+
+        /* Builds the CSR arrays from an edge list (self loops are dropped, parallel edges merged).
+         * Merged parallel edges accumulate their weights. */
+        void build(int n, vector<pair<int, int>> &edges, const vector<double> *weights = NULL);
+
+        int getVertexCnt() const { return n; }
+        long getEdgeCnt() const { return adj.size() / 2; }
+        int degree(int v) const { return offset[v+1] - offset[v]; }
+        const int *neighbours(int v) const { return &adj[offset[v]]; }
+        const double *weights(int v) const { return &weight[offset[v]]; }
+        bool isWeighted() const { return !weight.empty(); }
+
+        bool readGR(FILE *f);                                                   // Reads a graph in PACE .gr format ("p tw n m")
+        bool readGR(const string &path);
+        void writeGR(FILE *f) const;
+
+        int components(vector<int> &comp) const;                                // Labels connected components, returns their count
+        int blocks(vector<vector<int>> &blk) const;                             // Biconnected blocks (vertex sets), returns their count
+        Graph induced(const vector<int> &vertices) const;                       // Subgraph induced by 'vertices' (i-th vertex becomes i)
+        Graph range(int lo, int hi) const;                                      // Subgraph induced by the vertices lo..hi-1 (v becomes v-lo)
+
+        /* heuristic treewidth */
+        int minDegreeOrder(vector<int> &order) const;                           // Greedy min-degree elimination ordering, returns its width
+        int minFillOrder(vector<int> &order) const;                             // Greedy min-fill elimination ordering, returns its width
+        int eliminationWidth(const vector<int> &order,
+                vector<vector<int>> *bags = NULL,
+                vector<int> *parent = NULL) const;                              // Width of 'order' (optionally its tree decomposition)
+        int degeneracy() const;                                                 // Lower bound on treewidth
+
+        /* community structure */
+        double modularity(const vector<int> &comm) const;                       // Newman modularity of the partition 'comm'
+        double louvain(vector<int> &comm, int threads = 1) const;               // Parallel Louvain partition, returns its modularity
+
+        int n;
+        vector<int> offset;
+        vector<int> adj;
+        vector<double> weight;
+};
+
+/*
+ * Min-degree orderings of windows [lo, hi) that advance over the vertex IDs.
+ *
+ * A vertex of the previous ordering is clean if neither it nor any vertex
+ * eliminated before it in its neighbourhood touched a leaving or an entering
+ * vertex, so it is eliminated exactly as before (same bag). The elimination
+ * graph after the clean vertices is the graph of the window plus a clique on
+ * the bag of every clean vertex; it is kept between windows as the list of
+ * clean bags containing each vertex, so moving the window only updates the
+ * bags of the vertices that became clean or dirty, and the greedy choice only
+ * runs on the dirty part.
+ */
+class MinDegreeWindow
+{
+    public:
+        MinDegreeWindow(const Graph &g);
+
+        int advance(int lo, int hi, bool refresh = false);                      // Orders the window [lo, hi) ('refresh': from scratch), returns its width
+        int getCleanCnt() const { return cleanCnt; }                            // Vertices of the window eliminated as in the previous one
+
+    private:
+        void setClean(int v, bool c);
+
+        const Graph &g;
+        int lo, hi;
+        vector<int> order;                                                      // Ordering of the window, clean vertices first
+        vector<vector<int>> bags;                                               // bags[v] of the vertices of the window
+        vector<vector<int>> cliques;                                            // cliques[v]: clean vertices whose bag contains 'v'
+        vector<char> clean;
+        vector<char> mark;
+        int cleanCnt;
+};
+
+/*
+ * Tree decomposition in PACE .td format. Bags are 0-based internally
+ * and hold 0-based vertex IDs.
+ */
+class TreeDecomposition
+{
+    public:
+        TreeDecomposition();
+
+        int getWidth() const;
+        int getBagCnt() const { return bags.size(); }
+        int findBag(int v) const;                                               // Index of some bag containing 'v', or -1
+
+        void fromElimination(const Graph &g, const vector<int> &order);
+        bool read(FILE *f);
+        bool read(const string &path);
+        void write(FILE *f) const;
+
+        void relabel(const vector<int> &map);                                   // Replaces every vertex 'v' by 'map[v]'
+        int append(const TreeDecomposition &td);                                // Adds all bags/edges of 'td', returns the offset of its bags
+        bool valid(const Graph &g) const;                                       // Mainly for debugging. Checks the three TD properties
+
+        vector<vector<int>> bags;
+        vector<pair<int, int>> edges;
+        int vertices;
+};
+
+/* Engine selection for computing tree decompositions */
+class TreewidthEngine
+{
+    public:
+        enum Heuristic {
+            MIN_DEGREE,
+            MIN_FILL,
+        };
+
+        TreewidthEngine(Heuristic h = MIN_DEGREE, string solver = "");
+
+        /* Decomposes 'g'. If an external solver is configured, it is invoked as
+         *   solver in.gr > out.td
+         * (the same way run.sh does); on failure the built-in heuristic is used. */
+        void decompose(const Graph &g, TreeDecomposition &td, int threshold = 0) const;
+
+        Heuristic heuristic;
+        string solver;
+        string tmpDir;
+};
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ * Proof complexity measures of an LRAT proof (drat-trim -L, text or -C binary)
+ * in one pass over the file:
+ *
+ *   - clause space: maximum number of live clauses (and literals, given the formula)
+ *   - depth: longest chain of antecedents from an input clause to a lemma
+ *   - width: maximum lemma (and input clause) width
+ *   - antecedent counts per lemma
+ *
+ * Only the live lemmas are kept (their depth and width), and deletions release
+ * them, so memory follows the clause space of the proof rather than its length.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+/* config options */
+char *cfg_formula;
+char *cfg_dump;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options] {proof.lrat}\n"
+            "  --help or -h                             Prints this message\n"
+            "  --formula or -f {input.cnf}              Formula of the proof (input widths and literal space)\n"
+            "  --dump or -d {file}                      Writes 'id width depth antecedents' for every lemma\n"
+          );
+}
+
+struct Lemma
+{
+    int depth;
+    int width;
+};
+
+/* LRAT reader for the text and the binary format of drat-trim */
+class LRATReader
+{
+    public:
+        LRATReader(FILE *f) : file(f)
+        {
+            int c = getc_unlocked(f);
+            binary = c == 'a' || c == 'd';
+            ungetc(c, f);
+        }
+
+        /* reads the next line; returns false on EOF */
+        bool next(bool &deletion, long &id, vector<int> &lits, vector<long> &hints)
+        {
+            lits.clear();
+            hints.clear();
+            long x;
+            if ( binary )
+            {
+                int c = getc_unlocked(file);
+                if ( c == EOF ) return false;
+                deletion = c == 'd';
+                if ( !deletion )
+                {
+                    if ( !readBinary(x) ) return false;
+                    id = x;
+                    while( readBinary(x) && x != 0 ) lits.push_back(x);
+                }
+                while( readBinary(x) && x != 0 ) hints.push_back(x);
+                return true;
+            }
+
+            if ( !readText(x) ) return false;
+            id = x;
+            int c = getc_unlocked(file);
+            while( c == ' ' ) c = getc_unlocked(file);
+            deletion = c == 'd';
+            if ( !deletion ) ungetc(c, file);
+            else
+            {
+                while( readText(x) && x != 0 ) hints.push_back(x);
+                return true;
+            }
+
+            while( readText(x) && x != 0 ) lits.push_back(x);
+            while( readText(x) && x != 0 ) hints.push_back(x);
+            return true;
+        }
+
+        bool binary;
+
+    private:
+        FILE *file;
+
+        bool readText(long &x)
+        {
+            int c = getc_unlocked(file);
+            while( c != EOF && c != '-' && (c < '0' || c > '9') )
+                c = getc_unlocked(file);
+            if ( c == EOF ) return false;
+
+            bool neg = c == '-';
+            if ( neg ) c = getc_unlocked(file);
+            x = 0;
+            while( c >= '0' && c <= '9' )
+            {
+                x = x * 10 + (c - '0');
+                c = getc_unlocked(file);
+            }
+            if ( neg ) x = -x;
+            return true;
+        }
+
+        /* variable-length '2*|x| + sign' encoding */
+        bool readBinary(long &x)
+        {
+            unsigned long u = 0;
+            int shift = 0, c;
+            do {
+                c = getc_unlocked(file);
+                if ( c == EOF ) return false;
+                u |= (unsigned long)(c & 127) << shift;
+                shift += 7;
+            } while( c & 128 );
+            x = (u & 1) ? -(long)(u >> 1) : (long)(u >> 1);
+            return true;
+        }
+};
+
+int main(int argc, char **argv)
+{
+    /* Arguments default values */
+    cfg_formula = NULL;
+    cfg_dump = NULL;
+
+    struct option long_options[] =
+    {
+        /* valued options */
+        {"formula", required_argument, 0, 'f'},
+        {"dump",    required_argument, 0, 'd'},
+        {"help",    no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "f:d:h", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 'f':
+                cfg_formula = optarg;
+                break;
+
+            case 'd':
+                cfg_dump = optarg;
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
+
+            default:
+                abort ();
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        display_usage();
+        return 1;
+    }
+
+    /* Input clause widths (optional) */
+    long inputs = -1;
+    vector<int> inputWidth;
+    int maxInputWidth = 0;
+    long liveLits = 0;
+    if ( cfg_formula )
+    {
+        FILE *f = fopen(cfg_formula, "r");
+        if ( !f ) { fprintf(stderr, "cannot open %s\n", cfg_formula); return 1; }
+        char line[1 << 16];
+        int w = 0;
+        while( fscanf(f, " %[cp]", line) == 1 )
+            if ( !fgets(line, sizeof(line), f) ) break;
+        int lit;
+        while( fscanf(f, "%d", &lit) == 1 )
+        {
+            if ( lit != 0 ) { w++; continue; }
+            inputWidth.push_back(w);
+            maxInputWidth = max(maxInputWidth, w);
+            liveLits += w;
+            w = 0;
+        }
+        fclose(f);
+        inputs = inputWidth.size();
+    }
+
+    FILE *in = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+    if ( !in ) { fprintf(stderr, "cannot open %s\n", argv[optind]); return 1; }
+    FILE *dump = cfg_dump ? fopen(cfg_dump, "w") : NULL;
+
+    LRATReader reader(in);
+    unordered_map<long, Lemma> live;
+    long liveClauses = max(inputs, 0L), maxLive = liveClauses, maxLiveLits = liveLits;
+    long lemmas = 0, deletions = 0, steps = 0;
+    int maxDepth = 0, maxWidth = 0, maxAnte = 0, emptyDepth = -1;
+    vector<long> anteHist;
+
+    bool deletion;
+    long id;
+    vector<int> lits;
+    vector<long> hints, pending;
+    while( reader.next(deletion, id, lits, hints) )
+    {
+        /* drat-trim numbers the first lemma right after the formula; deletions
+         * before it can only be of input clauses */
+        if ( inputs < 0 && deletion )
+        {
+            pending.insert(pending.end(), hints.begin(), hints.end());
+            continue;
+        }
+        if ( inputs < 0 )
+        {
+            inputs = id - 1;
+            maxLive = inputs;
+            liveClauses = inputs - pending.size();
+            deletions = pending.size();
+        }
+
+        if ( deletion )
+        {
+            for( long h : hints )
+            {
+                if ( h <= inputs )
+                {
+                    liveClauses--;
+                    if ( !inputWidth.empty() ) liveLits -= inputWidth[h - 1];
+                    continue;
+                }
+                auto it = live.find(h);
+                if ( it == live.end() ) continue;
+                liveClauses--;
+                liveLits -= it->second.width;
+                live.erase(it);
+            }
+            deletions += hints.size();
+            continue;
+        }
+
+        int depth = 0;
+        for( long h : hints )
+        {
+            long a = labs(h);
+            if ( a <= inputs ) continue;
+            auto it = live.find(a);
+            if ( it == live.end() )
+            {
+                fprintf(stderr, "Lemma %ld uses unknown or deleted clause %ld\n", id, a);
+                return 1;
+            }
+            depth = max(depth, it->second.depth);
+        }
+        depth++;
+
+        Lemma l;
+        l.depth = depth;
+        l.width = lits.size();
+        live[id] = l;
+
+        lemmas++;
+        liveClauses++;
+        liveLits += l.width;
+        maxLive = max(maxLive, liveClauses);
+        maxLiveLits = max(maxLiveLits, liveLits);
+        maxDepth = max(maxDepth, depth);
+        maxWidth = max(maxWidth, l.width);
+        if ( l.width == 0 ) emptyDepth = depth;
+
+        int ante = hints.size();
+        steps += ante;
+        maxAnte = max(maxAnte, ante);
+        if ( ante >= (int)anteHist.size() ) anteHist.resize(ante + 1, 0);
+        anteHist[ante]++;
+
+        if ( dump ) fprintf(dump, "%ld %d %d %d\n", id, l.width, depth, ante);
+    }
+
+    if ( in != stdin ) fclose(in);
+    if ( dump ) fclose(dump);
+
+    /* median from the histogram */
+    long seen = 0;
+    int median = 0;
+    for( size_t i=0; i<anteHist.size(); i++ )
+    {
+        seen += anteHist[i];
+        if ( 2 * seen >= lemmas ) { median = i; break; }
+    }
+
+    printf("inputs %ld\n", max(inputs, 0L));
+    printf("lemmas %ld\n", lemmas);
+    printf("deletions %ld\n", deletions);
+    printf("space_clauses %ld\n", maxLive);
+    if ( cfg_formula ) printf("space_literals %ld\n", maxLiveLits);
+    printf("depth %d\n", maxDepth);
+    printf("empty_clause_depth %d\n", emptyDepth);
+    printf("width %d\n", maxWidth);
+    if ( cfg_formula ) printf("input_width %d\n", maxInputWidth);
+    printf("antecedents_total %ld\n", steps);
+    printf("antecedents_avg %.3f\n", lemmas ? (double)steps / lemmas : 0.0);
+    printf("antecedents_median %d\n", median);
+    printf("antecedents_max %d\n", maxAnte);
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * Cheap width estimates for proof graphs that are too large to decompose.
+ *
+ * ball:   BFS balls over antecedents (neighbours with a smaller ID) around
+ *         randomly chosen lemmas. The min-degree width of each induced ball is
+ *         one sample; the mean is reported with a 95% confidence interval.
+ * prefix: proof prefixes of doubling length. log(width) is fitted against
+ *         log(prefix length) and extrapolated to the whole proof with a 95%
+ *         prediction interval.
+ */
+
+#include "graph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+
+enum SampleMode {
+    SM_BALL,
+    SM_PREFIX,
+    SM_NONE
+};
+
+/* 97.5% quantile of Student's t distribution with df degrees of freedom */
+static double t975(int df)
+{
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+         2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    return df <= 30 ? table[df - 1] : 1.96 + 2.4 / df;                         // within 0.005 beyond the table
+}
+
+/* config options */
+SampleMode cfg_mode;
+int cfg_samples;
+int cfg_size;
+int cfg_max_size;
+int cfg_drop;
+int cfg_threads;
+int cfg_verbose;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options] {input.gr}\n"
+            "  --help or -h                             Prints this message\n"
+            "  --mode or -m {ball | prefix}             Sampled subgraphs (default: ball)\n"
+            "  --samples or -n {int}                    Number of balls (default: 32)\n"
+            "  --size or -k {int}                       Vertices in a ball / in the shortest prefix (default: 1000)\n"
+            "  --max_size or -M {int}                   Longest prefix (default: 64 * size)\n"
+            "  --drop or -r {int}                       Ignores vertices 1..int, e.g. the input clauses of a core (default: 0)\n"
+            "  --threads or -j {int}                    Number of samples decomposed in parallel (default: all cores)\n"
+            "  --seed or -s {int}                       Random seed (default: time)\n"
+            "  --verbose or -v                          Prints every sample\n"
+          );
+}
+
+/* vertices reached from 'root' going to antecedents only, breadth first */
+static void ball(const Graph &g, int root, int size, vector<int> &vertices)
+{
+    unordered_set<int> seen;
+    seen.insert(root);
+    vertices.assign(1, root);
+    for( size_t i=0; i<vertices.size() && (int)vertices.size()<size; i++ )
+    {
+        int v = vertices[i];
+        for( int j=g.offset[v]; j<g.offset[v+1] && (int)vertices.size()<size; j++ )
+        {
+            int u = g.adj[j];
+            if ( u >= v || u < cfg_drop || !seen.insert(u).second ) continue;
+            vertices.push_back(u);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long seed = time( NULL );
+
+    /* Arguments default values */
+    cfg_mode = SM_BALL;
+    cfg_samples = 32;
+    cfg_size = 1000;
+    cfg_max_size = -1;
+    cfg_drop = 0;
+    cfg_threads = thread::hardware_concurrency();
+    cfg_verbose = 0;
+
+    struct option long_options[] =
+    {
+        /* valued options */
+        {"mode",     required_argument, 0, 'm'},
+        {"samples",  required_argument, 0, 'n'},
+        {"size",     required_argument, 0, 'k'},
+        {"max_size", required_argument, 0, 'M'},
+        {"drop",     required_argument, 0, 'r'},
+        {"threads",  required_argument, 0, 'j'},
+        {"seed",     required_argument, 0, 's'},
+        {"verbose",  no_argument,       0, 'v'},
+        {"help",     no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "m:n:k:M:r:j:s:vh", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 'm':
+                cfg_mode = strcmp(optarg, "ball") == 0 ? SM_BALL :
+                    strcmp(optarg, "prefix") == 0 ? SM_PREFIX :
+                    SM_NONE;
+                if ( cfg_mode == SM_NONE )
+                {
+                    fprintf(stderr, "Invalid or missing sampling mode!\nUse -m or --mode\n");
+                    return 1;
+                }
+                break;
+
+            case 'n':
+                cfg_samples = atoi(optarg);
+                break;
+
+            case 'k':
+                cfg_size = atoi(optarg);
+                break;
+
+            case 'M':
+                cfg_max_size = atoi(optarg);
+                break;
+
+            case 'r':
+                cfg_drop = atoi(optarg);
+                break;
+
+            case 'j':
+                cfg_threads = atoi(optarg);
+                break;
+
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
+            case 'v':
+                cfg_verbose = 1;
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
+
+            default:
+                abort ();
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        display_usage();
+        return 1;
+    }
+    if ( cfg_samples < 1 )
+    {
+        fprintf(stderr, "Number of samples must be positive!\n");
+        return 1;
+    }
+    if ( cfg_threads < 1 ) cfg_threads = 1;
+    if ( cfg_size < 2 ) cfg_size = 2;
+    if ( cfg_max_size < 0 ) cfg_max_size = 64 * cfg_size;
+    cfg_drop = max(cfg_drop, 0);
+    srand48(seed);
+
+    Graph g;
+    if ( !g.readGR(argv[optind]) )
+        return 1;
+
+    /* The sampled subgraphs, drawn up front so that the result only depends on the seed */
+    vector<vector<int>> samples;
+    if ( cfg_mode == SM_BALL )
+    {
+        vector<int> lemmas;
+        for( int v=cfg_drop; v<g.n; v++ )
+            for( int j=g.offset[v]; j<g.offset[v+1]; j++ )
+                if ( g.adj[j] < v && g.adj[j] >= cfg_drop )
+                {
+                    lemmas.push_back(v);
+                    break;
+                }
+        if ( lemmas.empty() )
+        {
+            fprintf(stderr, "No lemma with antecedents to sample from!\n");
+            return 1;
+        }
+
+        samples.resize(cfg_samples);
+        for( int i=0; i<cfg_samples; i++ )
+            samples[i].assign(1, lemmas[lrand48() % lemmas.size()]);
+    }
+    else
+    {
+        if ( cfg_drop >= g.n )
+        {
+            fprintf(stderr, "No lemma left after dropping %d vertices!\n", cfg_drop);
+            return 1;
+        }
+        for( long len=cfg_size; ; len*=2 )
+        {
+            int hi = min((long)g.n, cfg_drop + min(len, (long)cfg_max_size));
+            samples.push_back(vector<int>(1, hi));
+            if ( hi == g.n || len >= cfg_max_size ) break;
+        }
+    }
+
+    /* Decompose the samples in parallel */
+    vector<int> width(samples.size()), vertices(samples.size());
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for( size_t i; (i = next++) < samples.size(); )
+        {
+            Graph sub;
+            if ( cfg_mode == SM_BALL )
+            {
+                vector<int> vs;
+                ball(g, samples[i][0], cfg_size, vs);
+                sub = g.induced(vs);
+            }
+            else
+                sub = g.range(cfg_drop, samples[i][0]);
+
+            vector<int> order;
+            vertices[i] = sub.n;
+            width[i] = sub.minDegreeOrder(order);
+        }
+    };
+
+    vector<thread> workers;
+    for( int i=1; i<cfg_threads; i++ )
+        workers.push_back(thread(worker));
+    worker();
+    for( thread &t : workers )
+        t.join();
+
+    int n = samples.size();
+    if ( cfg_verbose )
+        for( int i=0; i<n; i++ )
+            printf("c sample %s %d vertices %d width %d\n",
+                    cfg_mode == SM_BALL ? "root" : "end", samples[i][0] + (cfg_mode == SM_BALL ? 1 : 0), vertices[i], width[i]);
+
+    if ( cfg_mode == SM_BALL )
+    {
+        double mean = 0, var = 0;
+        for( int w : width )
+            mean += w;
+        mean /= n;
+        for( int w : width )
+            var += (w - mean) * (w - mean);
+        var = n > 1 ? var / (n - 1) : 0;
+        double half = n > 1 ? t975(n - 1) * sqrt(var / n) : 0;
+
+        printf("samples %d\n", n);
+        printf("width_mean %.2f\n", mean);
+        printf("width_ci95 %.2f %.2f\n", mean - half, mean + half);
+        printf("width_stddev %.2f\n", sqrt(var));
+        printf("width_max %d\n", *max_element(width.begin(), width.end()));
+    }
+    else
+    {
+        /* least squares fit of log(width) = a + b log(length) */
+        vector<double> x, y;
+        for( int i=0; i<n; i++ )
+        {
+            printf("prefix %d width %d\n", vertices[i], width[i]);
+            if ( width[i] > 0 )
+            {
+                x.push_back(log(vertices[i]));
+                y.push_back(log(width[i]));
+            }
+        }
+
+        int m = x.size();
+        if ( samples.back()[0] == g.n )
+            printf("width %d\n", width.back());
+        else if ( m < 3 )
+            printf("c not enough prefixes for an estimate, increase --max_size\n");
+        else
+        {
+            double mx = 0, my = 0, sxx = 0, sxy = 0, sse = 0;
+            for( int i=0; i<m; i++ ) { mx += x[i]; my += y[i]; }
+            mx /= m; my /= m;
+            for( int i=0; i<m; i++ )
+            {
+                sxx += (x[i] - mx) * (x[i] - mx);
+                sxy += (x[i] - mx) * (y[i] - my);
+            }
+            double b = sxy / sxx, a = my - b * mx;
+            for( int i=0; i<m; i++ )
+                sse += (y[i] - a - b * x[i]) * (y[i] - a - b * x[i]);
+
+            double x0 = log(g.n - cfg_drop);
+            double s = sqrt(sse / (m - 2) * (1 + 1.0 / m + (x0 - mx) * (x0 - mx) / sxx));
+            double est = a + b * x0, t = t975(m - 2);
+            printf("growth_exponent %.3f\n", b);
+            printf("width_estimate %.1f\n", exp(est));
+            printf("width_pi95 %.1f %.1f\n", exp(est - t * s), exp(est + t * s));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Splits a .gr graph into connected components or biconnected blocks,
+ * decomposes every piece in parallel and stitches the tree decompositions
+ * of the pieces back into a tree decomposition of the whole graph.
+ *
+ * Blocks only share articulation vertices, so joining a bag containing the
+ * articulation vertex in the child block to a bag containing it in the parent
+ * block (following the block-cut tree) keeps every vertex's bags connected.
+ * The width of the result is the maximum over the pieces.
+ */
+
+#include "graph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+enum SplitMode {
+    SM_COMPONENTS,
+    SM_BLOCKS,
+    SM_NONE
+};
+
+/* config options */
+SplitMode cfg_mode;
+int cfg_threads;
+int cfg_drop;
+int cfg_threshold;
+int cfg_check;
+TreewidthEngine cfg_engine;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options] {input.gr}\n"
+            "  --help or -h                             Prints this message\n"
+            "  --mode or -m {components | blocks}       Pieces the graph is split into (default: blocks)\n"
+            "  --solver or -s {command}                 External treewidth solver, run as 'command piece.gr > piece.td'\n"
+            "                                           (default: built-in elimination heuristic)\n"
+            "  --heuristic or -H {min_degree | min_fill}\n"
+            "                                           Built-in heuristic (default: min_degree)\n"
+            "  --threads or -j {int}                    Number of pieces decomposed in parallel (default: all cores)\n"
+            "  --drop or -r {int}                       Removes vertices 1..int first, e.g. the input clauses of a core (default: 0)\n"
+            "  --threshold or -t {int}                  Pieces up to this many vertices skip the external solver (default: 16)\n"
+            "  --check                                  Verifies the stitched decomposition\n"
+            "The tree decomposition is printed to stdout in PACE .td format.\n"
+          );
+}
+
+/* a piece of the graph and where it hangs in the block-cut forest */
+struct Piece
+{
+    vector<int> vertices;
+    int parent;                 // index of the parent piece, -1 for a root
+    int cut;                    // articulation vertex shared with the parent
+    TreeDecomposition td;
+};
+
+/* pieces small enough (or complete) to be a single bag */
+static bool trivial(const Graph &g)
+{
+    long k = g.n;
+    return k <= 2 || g.getEdgeCnt() == k * (k - 1) / 2;
+}
+
+int main(int argc, char **argv)
+{
+    /* Arguments default values */
+    cfg_mode = SM_BLOCKS;
+    cfg_threads = thread::hardware_concurrency();
+    cfg_drop = 0;
+    cfg_threshold = 16;
+    cfg_check = 0;
+
+    struct option long_options[] =
+    {
+        /* flag options */
+        {"check",     no_argument, &cfg_check, 1},
+        /* valued options */
+        {"mode",      required_argument, 0, 'm'},
+        {"solver",    required_argument, 0, 's'},
+        {"heuristic", required_argument, 0, 'H'},
+        {"threads",   required_argument, 0, 'j'},
+        {"drop",      required_argument, 0, 'r'},
+        {"threshold", required_argument, 0, 't'},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "m:s:H:j:r:t:h", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 0:
+                break;
+
+            case 'm':
+                cfg_mode = strcmp(optarg, "components") == 0 ? SM_COMPONENTS :
+                    strcmp(optarg, "blocks") == 0 ? SM_BLOCKS :
+                    SM_NONE;
+                if ( cfg_mode == SM_NONE )
+                {
+                    fprintf(stderr, "Invalid or missing split mode!\nUse -m or --mode\n");
+                    return 1;
+                }
+                break;
+
+            case 's':
+                cfg_engine.solver = optarg;
+                break;
+
+            case 'H':
+                if ( strcmp(optarg, "min_degree") == 0 ) cfg_engine.heuristic = TreewidthEngine::MIN_DEGREE;
+                else if ( strcmp(optarg, "min_fill") == 0 ) cfg_engine.heuristic = TreewidthEngine::MIN_FILL;
+                else
+                {
+                    fprintf(stderr, "Invalid or missing heuristic!\nUse -h to see the options\n");
+                    return 1;
+                }
+                break;
+
+            case 'j':
+                cfg_threads = atoi(optarg);
+                break;
+
+            case 'r':
+                cfg_drop = atoi(optarg);
+                break;
+
+            case 't':
+                cfg_threshold = atoi(optarg);
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
+
+            default:
+                abort ();
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        display_usage();
+        return 1;
+    }
+    if ( cfg_threads < 1 ) cfg_threads = 1;
+
+    Graph input;
+    if ( !input.readGR(argv[optind]) )
+        return 1;
+
+    /* Remove the dropped vertices; 'keep[i]' is the input vertex of vertex 'i' */
+    vector<int> keep;
+    for( int v=max(cfg_drop, 0); v<input.n; v++ )
+        keep.push_back(v);
+    Graph g = cfg_drop > 0 ? input.induced(keep) : input;
+
+    /* Split */
+    vector<Piece> pieces;
+    if ( cfg_mode == SM_COMPONENTS )
+    {
+        vector<int> comp;
+        int cnt = g.components(comp);
+        pieces.resize(cnt);
+        for( int v=0; v<g.n; v++ )
+            pieces[comp[v]].vertices.push_back(v);
+        for( Piece &p : pieces )
+            p.parent = p.cut = -1;
+    }
+    else
+    {
+        vector<vector<int>> blk;
+        g.blocks(blk);
+
+        vector<vector<int>> at(g.n);                                            // blocks containing each vertex
+        for( size_t i=0; i<blk.size(); i++ )
+            for( int v : blk[i] )
+                at[v].push_back(i);
+
+        /* Order the blocks along a BFS of the block-cut forest */
+        pieces.reserve(blk.size());
+        vector<int> index(blk.size(), -1);
+        for( size_t s=0; s<blk.size(); s++ )
+        {
+            if ( index[s] != -1 ) continue;
+            index[s] = pieces.size();
+            pieces.push_back(Piece());
+            pieces.back().parent = pieces.back().cut = -1;
+            pieces.back().vertices.swap(blk[s]);
+
+            for( size_t q=index[s]; q<pieces.size(); q++ )
+                for( int v : pieces[q].vertices )
+                {
+                    if ( at[v].size() < 2 ) continue;
+                    for( int b : at[v] )
+                    {
+                        if ( index[b] != -1 ) continue;
+                        index[b] = pieces.size();
+                        pieces.push_back(Piece());
+                        pieces.back().parent = q;
+                        pieces.back().cut = v;
+                        pieces.back().vertices.swap(blk[b]);
+                    }
+                    at[v].clear();
+                }
+        }
+    }
+
+    /* Decompose the pieces, largest first */
+    vector<int> jobs;
+    for( size_t i=0; i<pieces.size(); i++ )
+        jobs.push_back(i);
+    sort(jobs.begin(), jobs.end(), [&](int a, int b){ return pieces[a].vertices.size() > pieces[b].vertices.size(); });
+
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for( size_t j; (j = next++) < jobs.size(); )
+        {
+            Piece &p = pieces[jobs[j]];
+            Graph sub = g.induced(p.vertices);
+            if ( trivial(sub) )
+            {
+                p.td.bags.assign(1, p.vertices);
+                continue;
+            }
+            cfg_engine.decompose(sub, p.td, cfg_threshold);
+            p.td.relabel(p.vertices);
+        }
+    };
+
+    vector<thread> workers;
+    for( int i=1; i<cfg_threads; i++ )
+        workers.push_back(thread(worker));
+    worker();
+    for( thread &t : workers )
+        t.join();
+
+    /* Stitch */
+    TreeDecomposition td;
+    td.vertices = g.n;
+    vector<int> base(pieces.size());
+    size_t largest = 0;
+    for( size_t i=0; i<pieces.size(); i++ )
+    {
+        Piece &p = pieces[i];
+        largest = max(largest, p.vertices.size());
+        base[i] = td.append(p.td);
+
+        if ( p.parent != -1 )
+        {
+            int mine = p.td.findBag(p.cut);
+            int theirs = pieces[p.parent].td.findBag(p.cut);
+            td.edges.push_back(make_pair(base[p.parent] + theirs, base[i] + mine));
+        }
+        else if ( i > 0 )
+            td.edges.push_back(make_pair(0, base[i]));
+    }
+    if ( td.bags.empty() ) td.bags.push_back(vector<int>());
+
+    if ( cfg_check && !td.valid(g) )
+    {
+        fprintf(stderr, "Stitched tree decomposition is invalid!\n");
+        return 1;
+    }
+
+    fprintf(stderr, "c %zu pieces, largest %zu vertices, width %d\n", pieces.size(), largest, td.getWidth());
+    /* a decomposition of the remaining graph, which is all it is valid for */
+    if ( cfg_drop > 0 )
+        printf("c vertices 1..%d of the input removed, vertex v is input vertex v+%d\n", cfg_drop, cfg_drop);
+    td.write(stdout);
+
+    return 0;
+}
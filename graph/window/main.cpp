@@ -0,0 +1,127 @@
+/*
+ * Width of a proof over time. The dependency graph is sliced by lemma ID into
+ * windows [lo, lo+size) that advance by 'step' lemmas, and the subgraph induced
+ * by every window is decomposed with the min-degree heuristic.
+ *
+ * Overlapping windows share their elimination state. A lemma of the previous
+ * ordering is clean if neither it nor any lemma eliminated before it in its
+ * neighbourhood touched a leaving or an entering lemma; the clean lemmas are
+ * eliminated exactly as in the previous window (same neighbourhoods, same bags),
+ * so the elimination graph after them is carried over (see MinDegreeWindow) and
+ * the greedy choice only runs on the part of the window that changed. Every
+ * 'refresh' windows the ordering is recomputed from scratch to stop the kept
+ * part from drifting.
+ */
+
+#include "graph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <algorithm>
+
+/* config options */
+int cfg_size;
+int cfg_step;
+int cfg_drop;
+int cfg_refresh;
+
+void display_usage()
+{
+    printf("USAGE: ./main [options] {input.gr}\n"
+            "  --help or -h                             Prints this message\n"
+            "  --size or -w {int}                       Number of lemmas in a window (default: 1000)\n"
+            "  --step or -s {int}                       Number of lemmas a window advances by (default: size/4)\n"
+            "  --drop or -r {int}                       Skips vertices 1..int, e.g. the input clauses of a core (default: 0)\n"
+            "  --refresh or -R {int}                    Computes a fresh ordering every int windows (default: 8)\n"
+            "Prints one line per window: first_lemma last_lemma vertices edges lower_bound width replayed\n"
+          );
+}
+
+int main(int argc, char **argv)
+{
+    /* Arguments default values */
+    cfg_size = 1000;
+    cfg_step = -1;
+    cfg_drop = 0;
+    cfg_refresh = 8;
+
+    struct option long_options[] =
+    {
+        /* valued options */
+        {"size",      required_argument, 0, 'w'},
+        {"step",      required_argument, 0, 's'},
+        {"drop",      required_argument, 0, 'r'},
+        {"refresh",   required_argument, 0, 'R'},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Process command line */
+    int c, option_index;
+    while( (c = getopt_long(argc, argv, "w:s:r:R:h", long_options, &option_index)) != -1 )
+    {
+        switch ( c )
+        {
+            case 'w':
+                cfg_size = atoi(optarg);
+                break;
+
+            case 's':
+                cfg_step = atoi(optarg);
+                break;
+
+            case 'r':
+                cfg_drop = atoi(optarg);
+                break;
+
+            case 'R':
+                cfg_refresh = atoi(optarg);
+                break;
+
+            case 'h':
+                display_usage();
+                return 1;
+
+            case '?':
+                return 1;
+
+            default:
+                abort ();
+        }
+    }
+
+    if ( optind >= argc )
+    {
+        display_usage();
+        return 1;
+    }
+    if ( cfg_size < 1 )
+    {
+        fprintf(stderr, "Window size must be positive!\n");
+        return 1;
+    }
+    if ( cfg_step < 1 ) cfg_step = max(1, cfg_size / 4);
+    if ( cfg_refresh < 1 ) cfg_refresh = 1;
+
+    Graph g;
+    if ( !g.readGR(argv[optind]) )
+        return 1;
+
+    MinDegreeWindow md(g);
+    int windows = 0;
+
+    printf("c first_lemma last_lemma vertices edges lower_bound width replayed\n");
+    for( int lo=max(cfg_drop, 0); lo<g.n; lo+=cfg_step )
+    {
+        int hi = min(lo + cfg_size, g.n);
+        Graph w = g.range(lo, hi);
+        int width = md.advance(lo, hi, windows++ % cfg_refresh == 0);
+
+        printf("%d %d %d %ld %d %d %d\n", lo + 1, hi, w.n, w.getEdgeCnt(), w.degeneracy(), width, md.getCleanCnt());
+        fflush(stdout);
+
+        if ( hi == g.n ) break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/***************************************************************************************[Profile.h]
+ Hot-path counters of the solver, compiled in with '-D PROFILE_COUNTERS' (e.g. 'make rs
+ CMD_CFLAGS=-DPROFILE_COUNTERS' after a 'make clean'). Without the flag, the macros below expand
+ to nothing and the solver is unchanged.
+
+ The counters are:
+   - cycles and calls per phase. The phases nest: 'analyze' includes 'minimize', and proof writing
+     is also part of the phase that writes;
+   - histograms of the lengths of the binary, ternary and long watch lists visited by 'propagate()',
+     bucket 'i' counting the lists of length in [2^(i-1), 2^i) (bucket 0: the empty lists);
+   - the number of long clauses 'propagate()' has to look at (because their blocker is not true),
+     split into problem clauses and the three tiers of learnt clauses, and of ternary clauses.
+ 'Solver::writeProfile()' writes them as one JSON object per line (after "c profile " in the
+ solver output).
+ **************************************************************************************************/
+
+#ifndef Glucose_Profile_h
+#define Glucose_Profile_h
+
+#ifdef PROFILE_COUNTERS
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#include <string.h>
+
+#include "mtl/IntTypes.h"
+
+namespace Glucose {
+
+enum ProfilePhase { PROF_PROPAGATE, PROF_ANALYZE, PROF_MINIMIZE, PROF_REDUCEDB, PROF_GC, PROF_PROOF, PROF_NB_PHASES };
+enum ProfileWatches { PROF_BINARY, PROF_TERNARY, PROF_LONG, PROF_NB_WATCHES };
+
+static const char* const profile_phases [PROF_NB_PHASES]  = { "propagate", "analyze", "minimize", "reduceDB", "garbageCollect", "proof" };
+static const char* const profile_watches[PROF_NB_WATCHES] = { "binary", "ternary", "long" };
+
+// Time stamp counter (or nanoseconds where there is none):
+static inline uint64_t profileCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+struct Profile {
+    enum { NB_BUCKETS = 24 };
+
+    uint64_t cycles[PROF_NB_PHASES];
+    uint64_t calls [PROF_NB_PHASES];
+    uint64_t watch_lengths[PROF_NB_WATCHES][NB_BUCKETS];
+    uint64_t clause_visits[4];                  // Problem clauses, then learnt clauses by tier.
+    uint64_t ternary_visits;
+
+    Profile() { memset(this, 0, sizeof(*this)); }
+
+    void watchLength(int kind, int n) {
+        int b = n == 0 ? 0 : 32 - __builtin_clz(n);
+        watch_lengths[kind][b < NB_BUCKETS ? b : NB_BUCKETS - 1]++; }
+};
+
+// Adds the cycles of its lifetime to a phase:
+class ProfileScope {
+    Profile& profile;
+    int      phase;
+    uint64_t start;
+public:
+    ProfileScope(Profile& p, int ph) : profile(p), phase(ph), start(profileCycles()) {}
+    ~ProfileScope() { profile.cycles[phase] += profileCycles() - start; profile.calls[phase]++; }
+};
+
+}
+
+#define PROFILE_PHASE(phase) ProfileScope _profile_scope(profile, phase)
+#define PROFILE(stmt)        stmt
+
+#else
+
+#define PROFILE_PHASE(phase)
+#define PROFILE(stmt)
+
+#endif
+
+#endif
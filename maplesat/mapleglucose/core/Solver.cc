@@ -76,6 +76,10 @@ static IntOption opt_first_reduce_db(_cred, "firstReduceDB", "The number of conf
 static IntOption opt_inc_reduce_db(_cred, "incReduceDB", "Increment for reduce DB", 300, IntRange(0, INT32_MAX));
 static IntOption opt_spec_inc_reduce_db(_cred, "specialIncReduceDB", "Special increment for reduce DB", 1000, IntRange(0, INT32_MAX));
 static IntOption opt_lb_lbd_frozen_clause(_cred, "minLBDFrozenClause", "Protect clauses if their LBD decrease and is lower than (for one turn)", 30, IntRange(0, INT32_MAX));
+static IntOption opt_core_lbd(_cred, "coreLBD", "Learnt clauses up to this LBD are never deleted", 2, IntRange(0, INT32_MAX));
+static IntOption opt_tier2_lbd(_cred, "tier2LBD", "Learnt clauses up to this LBD are kept as long as they are used between reductions", 6, IntRange(0, INT32_MAX));
+static IntOption opt_vivify_confl(_cred, "vivify-confl", "The number of conflicts between two vivifications of the core and tier-2 learnt clauses (0=never)", 0, IntRange(0, INT32_MAX));
+static DoubleOption opt_vivify_eff(_cred, "vivify-eff", "The propagations of a vivification, relative to the ones of the search since the last one", 0.1, DoubleRange(0, false, HUGE_VAL, false));
 
 static IntOption opt_lb_size_minimzing_clause(_cm, "minSizeMinimizingClause", "The min size required to minimize clause", 30, IntRange(3, INT32_MAX));
 static IntOption opt_lb_lbd_minimzing_clause(_cm, "minLBDMinimizingClause", "The min LBD required to minimize clause", 6, IntRange(3, INT32_MAX));
@@ -89,10 +93,16 @@ static DoubleOption opt_random_var_freq(_cat, "rnd-freq", "The frequency with wh
 static DoubleOption opt_random_seed(_cat, "rnd-seed", "Used by the random variable selection", 91648253, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption opt_ccmin_mode(_cat, "ccmin-mode", "Controls conflict clause minimization (0=none, 1=basic, 2=deep)", 2, IntRange(0, 2));
 static IntOption opt_phase_saving(_cat, "phase-saving", "Controls the level of phase saving (0=none, 1=limited, 2=full)", 2, IntRange(0, 2));
+static IntOption opt_chrono(_cat, "chrono", "Backtrack chronologically when a backjump would undo more levels than this (-1=never)", -1, IntRange(-1, INT32_MAX));
+static BoolOption opt_reuse_trail(_cr, "reuse-trail", "Restart only below the decisions more active than the next one", true);
+static IntOption opt_confl_to_chrono(_cat, "confl-to-chrono", "The number of conflicts before backtracking chronologically", 4000, IntRange(0, INT32_MAX));
 static BoolOption opt_rnd_init_act(_cat, "rnd-init", "Randomize the initial activity", false);
 static DoubleOption opt_garbage_frac(_cat, "gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered", 0.20, DoubleRange(0, false, HUGE_VAL, false));
 static DoubleOption  opt_reward_multiplier(_cat, "reward-multiplier", "Reward multiplier", 0.9, DoubleRange(0, true, 1, true));
 static DoubleOption  opt_optimistic_initial_value(_cat, "optimistic-initial-value", "Optimistic initial value", 0.0, DoubleRange(0, true, HUGE_VAL, false));
+#ifdef PROFILE_COUNTERS
+static IntOption opt_profile_every(_cat, "profile-every", "Write the profile counters every this many conflicts (0=only at the end)", 0, IntRange(0, INT32_MAX));
+#endif
 
 
 //=================================================================================================
@@ -112,6 +122,10 @@ verbosity(0)
 , incReduceDB(opt_inc_reduce_db)
 , specialIncReduceDB(opt_spec_inc_reduce_db)
 , lbLBDFrozenClause(opt_lb_lbd_frozen_clause)
+, coreLBD(opt_core_lbd)
+, tier2LBD(opt_tier2_lbd)
+, vivify_confl(opt_vivify_confl)
+, vivify_eff(opt_vivify_eff)
 , lbSizeMinimizingClause(opt_lb_size_minimzing_clause)
 , lbLBDMinimizingClause(opt_lb_lbd_minimzing_clause)
 , step_size(opt_step_size)
@@ -122,11 +136,20 @@ verbosity(0)
 , random_seed(opt_random_seed)
 , ccmin_mode(opt_ccmin_mode)
 , phase_saving(opt_phase_saving)
+, chrono(opt_chrono)
+, confl_to_chrono(opt_confl_to_chrono)
+, reuse_trail(opt_reuse_trail)
 , rnd_pol(false)
 , rnd_init_act(opt_rnd_init_act)
 , garbage_frac(opt_garbage_frac)
 , certifiedOutput(NULL)
 , certifiedUNSAT(false) // Not in the first parallel version 
+, traceOutput(NULL)
+, traceProof(false)
+#ifdef PROFILE_COUNTERS
+, profileOutput(NULL)
+, profile_every(opt_profile_every)
+#endif
 , panicModeLastRemoved(0), panicModeLastRemovedShared(0)
 , useUnaryWatched(false)
 , promoteOneWatchedClause(true)
@@ -137,7 +160,9 @@ verbosity(0)
 , sumDecisionLevels(0)
 , nbRemovedClauses(0), nbRemovedUnaryWatchedClauses(0), nbReducedClauses(0), nbDL2(0), nbBin(0), nbUn(0), nbReduceDB(0)
 , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0), conflictsRestarts(0)
-, nbstopsrestarts(0), nbstopsrestartssame(0), lastblockatrestart(0)
+, nbstopsrestarts(0), nbstopsrestartssame(0), lastblockatrestart(0), nbChronoBacktracks(0), nbReusedTrail(0)
+, nbCoreLearnts(0), nbTier2Learnts(0), nbLocalLearnts(0), nbPromotedTier(0), nbDemotedTier(0)
+, nbVivifyRounds(0), nbVivified(0), nbVivifiedLits(0)
 , dec_vars(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 , action(0)
 , reward_multiplier(opt_reward_multiplier)
@@ -149,6 +174,7 @@ verbosity(0)
 , var_inc(1)
 , watches(WatcherDeleted(ca))
 , watchesBin(WatcherDeleted(ca))
+, watchesTer(WatcherDeleted(ca))
 , unaryWatches(WatcherDeleted(ca))
 , qhead(0)
 , simpDB_assigns(-1)
@@ -172,12 +198,16 @@ verbosity(0)
 , nbUnsatCalls(0)
 {
     MYFLAG = 0;
+    nextClauseId = 0;
+    unitsTraced = 0;
     // Initialize only first time. Useful for incremental solving (not in // version), useless otherwise
     // Kept here for simplicity
     lbdQueue.initSize(sizeLBDQueue);
     trailQueue.initSize(sizeTrailQueue);
     sumLBD = 0;
     nbclausesbeforereduce = firstReduceDB;
+    next_vivify = vivify_confl;
+    vivify_props = 0;
 }
 
 //-------------------------------------------------------
@@ -195,6 +225,10 @@ Solver::Solver(const Solver &s) :
 , incReduceDB(s.incReduceDB)
 , specialIncReduceDB(s.specialIncReduceDB)
 , lbLBDFrozenClause(s.lbLBDFrozenClause)
+, coreLBD(s.coreLBD)
+, tier2LBD(s.tier2LBD)
+, vivify_confl(s.vivify_confl)
+, vivify_eff(s.vivify_eff)
 , lbSizeMinimizingClause(s.lbSizeMinimizingClause)
 , lbLBDMinimizingClause(s.lbLBDMinimizingClause)
 , step_size(s.step_size)
@@ -205,11 +239,20 @@ Solver::Solver(const Solver &s) :
 , random_seed(s.random_seed)
 , ccmin_mode(s.ccmin_mode)
 , phase_saving(s.phase_saving)
+, chrono(s.chrono)
+, confl_to_chrono(s.confl_to_chrono)
+, reuse_trail(s.reuse_trail)
 , rnd_pol(s.rnd_pol)
 , rnd_init_act(s.rnd_init_act)
 , garbage_frac(s.garbage_frac)
 , certifiedOutput(NULL)
 , certifiedUNSAT(false) // Not in the first parallel version 
+, traceOutput(NULL)
+, traceProof(false)
+#ifdef PROFILE_COUNTERS
+, profileOutput(NULL)
+, profile_every(s.profile_every)
+#endif
 , panicModeLastRemoved(s.panicModeLastRemoved), panicModeLastRemovedShared(s.panicModeLastRemovedShared)
 , useUnaryWatched(s.useUnaryWatched)
 , promoteOneWatchedClause(s.promoteOneWatchedClause)
@@ -223,7 +266,10 @@ Solver::Solver(const Solver &s) :
 , solves(s.solves), starts(s.starts), decisions(s.decisions), rnd_decisions(s.rnd_decisions)
 , propagations(s.propagations), conflicts(s.conflicts), conflictsRestarts(s.conflictsRestarts)
 , nbstopsrestarts(s.nbstopsrestarts), nbstopsrestartssame(s.nbstopsrestartssame)
-, lastblockatrestart(s.lastblockatrestart)
+, lastblockatrestart(s.lastblockatrestart), nbChronoBacktracks(s.nbChronoBacktracks), nbReusedTrail(s.nbReusedTrail)
+, nbCoreLearnts(s.nbCoreLearnts), nbTier2Learnts(s.nbTier2Learnts), nbLocalLearnts(s.nbLocalLearnts)
+, nbPromotedTier(s.nbPromotedTier), nbDemotedTier(s.nbDemotedTier)
+, nbVivifyRounds(s.nbVivifyRounds), nbVivified(s.nbVivified), nbVivifiedLits(s.nbVivifiedLits)
 , dec_vars(s.dec_vars), clauses_literals(s.clauses_literals)
 , learnts_literals(s.learnts_literals), max_literals(s.max_literals), tot_literals(s.tot_literals)
 , action(0)
@@ -236,6 +282,7 @@ Solver::Solver(const Solver &s) :
 , var_inc(s.var_inc)
 , watches(WatcherDeleted(ca))
 , watchesBin(WatcherDeleted(ca))
+, watchesTer(WatcherDeleted(ca))
 , unaryWatches(WatcherDeleted(ca))
 , qhead(s.qhead)
 , simpDB_assigns(s.simpDB_assigns)
@@ -264,20 +311,26 @@ Solver::Solver(const Solver &s) :
 
     // Initialize  other variables
      MYFLAG = 0;
+    nextClauseId = 0;
+    unitsTraced = 0;
     // Initialize only first time. Useful for incremental solving (not in // version), useless otherwise
     // Kept here for simplicity
     sumLBD = s.sumLBD;
     nbclausesbeforereduce = s.nbclausesbeforereduce;
+    next_vivify = s.next_vivify;
+    vivify_props = s.vivify_props;
    
     // Copy all search vectors
     s.watches.copyTo(watches);
     s.watchesBin.copyTo(watchesBin);
+    s.watchesTer.copyTo(watchesTer);
     s.unaryWatches.copyTo(unaryWatches);
     s.assigns.memCopyTo(assigns);
     s.vardata.memCopyTo(vardata);
     s.activity.memCopyTo(activity);
     s.seen.memCopyTo(seen);
     s.permDiff.memCopyTo(permDiff);
+    s.unitIds.memCopyTo(unitIds);
     s.polarity.memCopyTo(polarity);
     s.decision.memCopyTo(decision);
     s.trail.memCopyTo(trail);
@@ -328,6 +381,8 @@ Var Solver::newVar(bool sign, bool dvar) {
     watches .init(mkLit(v, true));
     watchesBin .init(mkLit(v, false));
     watchesBin .init(mkLit(v, true));
+    watchesTer .init(mkLit(v, false));
+    watchesTer .init(mkLit(v, true));
     unaryWatches .init(mkLit(v, false));
     unaryWatches .init(mkLit(v, true));
     assigns .push(l_Undef);
@@ -339,6 +394,7 @@ Var Solver::newVar(bool sign, bool dvar) {
     decision .push();
     trail .capacity(v + 1);
     conflicted.push(0);
+    unitIds .push(0);
     setDecisionVar(v, dvar);
     return v;
 }
@@ -346,6 +402,19 @@ Var Solver::newVar(bool sign, bool dvar) {
 bool Solver::addClause_(vec<Lit>& ps) {
 
     assert(decisionLevel() == 0);
+
+    // Without antecedents, this is an input clause: it gets the next ID as it is.
+    uint64_t id = 0;
+    vec<uint64_t> hints;
+    if (traceProof) {
+        traceHints.moveTo(hints);
+        if (hints.size() == 0) {
+            id = ++nextClauseId;
+            traceClause(id, ps, ps.size(), hints);
+            hints.push(id);
+        }
+    }
+
     if (!ok) return false;
 
     // Check if clause is satisfied and remove false/duplicate literals:
@@ -364,6 +433,15 @@ bool Solver::addClause_(vec<Lit>& ps) {
         }
     }
 
+    if (traceProof) {
+        // The false literals are resolved away with their unit clauses:
+        trace_chain.clear();
+        for (i = 0; i < ps.size(); i++)
+            if (value(ps[i]) == l_False && (i == 0 || ps[i] != ps[i - 1]))
+                trace_chain.push(unitId(var(ps[i])));
+        if (trace_chain.size() > 0) id = 0; // (the shortened clause is derived)
+    }
+
     for (i = j = 0, p = lit_Undef; i < ps.size(); i++)
         if (value(ps[i]) == l_True || ps[i] == ~p)
             return true;
@@ -371,6 +449,13 @@ bool Solver::addClause_(vec<Lit>& ps) {
             ps[j++] = p = ps[i];
     ps.shrink(i - j);
 
+    if (traceProof && id == 0) {
+        for (i = 0; i < hints.size(); i++)
+            trace_chain.push(hints[i]);
+        id = ++nextClauseId;
+        traceClause(id, ps, ps.size(), trace_chain);
+    }
+
     if (flag && (certifiedUNSAT)) {
         for (i = j = 0, p = lit_Undef; i < ps.size(); i++)
             fprintf(certifiedOutput, "%i ", (var(ps[i]) + 1) * (-2 * sign(ps[i]) + 1));
@@ -386,10 +471,14 @@ bool Solver::addClause_(vec<Lit>& ps) {
     if (ps.size() == 0)
         return ok = false;
     else if (ps.size() == 1) {
+        if (traceProof) unitIds[var(ps[0])] = id;
         uncheckedEnqueue(ps[0]);
-        return ok = (propagate() == CRef_Undef);
+        CRef confl = propagate();
+        if (confl != CRef_Undef && traceProof) traceEmpty(confl);
+        return ok = (confl == CRef_Undef);
     } else {
         CRef cr = ca.alloc(ps, false);
+        if (traceProof) clauseIds.insert(cr, id);
         clauses.push(cr);
         attachClause(cr);
     }
@@ -404,6 +493,9 @@ void Solver::attachClause(CRef cr) {
     if (c.size() == 2) {
         watchesBin[~c[0]].push(Watcher(cr, c[1]));
         watchesBin[~c[1]].push(Watcher(cr, c[0]));
+    } else if (c.size() == 3) {
+        watchesTer[~c[0]].push(TernaryWatcher(cr, c[1], c[2]));
+        watchesTer[~c[1]].push(TernaryWatcher(cr, c[0], c[2]));
     } else {
         watches[~c[0]].push(Watcher(cr, c[1]));
         watches[~c[1]].push(Watcher(cr, c[0]));
@@ -433,6 +525,14 @@ void Solver::detachClause(CRef cr, bool strict) {
             watchesBin.smudge(~c[0]);
             watchesBin.smudge(~c[1]);
         }
+    } else if (c.size() == 3) {
+        if (strict) {
+            remove(watchesTer[~c[0]], TernaryWatcher(cr, c[1], c[2]));
+            remove(watchesTer[~c[1]], TernaryWatcher(cr, c[0], c[2]));
+        } else {
+            watchesTer.smudge(~c[0]);
+            watchesTer.smudge(~c[1]);
+        }
     } else {
         if (strict) {
             remove(watches[~c[0]], Watcher(cr, c[1]));
@@ -465,12 +565,18 @@ void Solver::removeClause(CRef cr, bool inPurgatory) {
     Clause& c = ca[cr];
 
     if (certifiedUNSAT) {
+        PROFILE_PHASE(PROF_PROOF);
         fprintf(certifiedOutput, "d ");
         for (int i = 0; i < c.size(); i++)
             fprintf(certifiedOutput, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
         fprintf(certifiedOutput, "0\n");
     }
 
+    if (traceProof) {
+        traceUnits(); // (the clause may be the reason of a top-level assignment)
+        if (clauseIds.has(cr)) clauseIds.remove(cr);
+    }
+
     if (inPurgatory)
         detachClausePurgatory(cr);
     else
@@ -566,6 +672,7 @@ inline unsigned int Solver::computeLBD(const Clause &c) {
  * Minimisation with binary reolution
  ******************************************************************/
 void Solver::minimisationWithBinaryResolution(vec<Lit> &out_learnt) {
+    PROFILE_PHASE(PROF_MINIMIZE);
 
     // Find the LBD measure                                                                                                         
     unsigned int lbd = computeLBD(out_learnt);
@@ -585,6 +692,7 @@ void Solver::minimisationWithBinaryResolution(vec<Lit> &out_learnt) {
             if (permDiff[var(imp)] == MYFLAG && value(imp) == l_True) {
                 nb++;
                 permDiff[var(imp)] = MYFLAG - 1;
+                if (traceProof) trace_bin.push(wbin[k]);
             }
         }
         int l = out_learnt.size() - 1;
@@ -607,12 +715,18 @@ void Solver::minimisationWithBinaryResolution(vec<Lit> &out_learnt) {
 }
 
 // Revert to the state at given level (keeping all assignment at 'level' but not beyond).
-//
+// After a chronological backtrack the trail is no longer sorted by level: the assignments at or
+// below 'level' found above 'trail_lim[level]' are kept, in trail order, and propagated again.
 
 void Solver::cancelUntil(int level) {
     if (decisionLevel() > level) {
+        trail_kept.clear();
         for (int c = trail.size() - 1; c >= trail_lim[level]; c--) {
             Var x = var(trail[c]);
+            if (chrono >= 0 && this->level(x) <= level) {
+                trail_kept.push(trail[c]);
+                continue;
+            }
             assigns [x] = l_Undef;
             if (phase_saving > 1 || ((phase_saving == 1) && c > trail_lim.last())) {
                 polarity[x] = sign(trail[c]);
@@ -622,9 +736,70 @@ void Solver::cancelUntil(int level) {
         qhead = trail_lim[level];
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        for (int i = trail_kept.size() - 1; i >= 0; i--)
+            trail.push_(trail_kept[i]);
     }
 }
 
+// With chronological backtracking a conflict can be below the current decision level. The literal
+// of the highest level is moved to 'c[0]' (and watched): if it is the only one of its level, the
+// clause is unit one level below, so the search backtracks there and implies 'c[0]' at the level of
+// 'c[1]'.
+
+int Solver::conflictLevel(CRef confl) {
+    Clause& c = ca[confl];
+    int highest = level(var(c[0]));
+    if (highest == decisionLevel() && level(var(c[1])) == highest)
+        return highest;
+
+    int highest_i = 0;
+    bool one = true;
+    for (int i = 1; i < c.size(); i++) {
+        int l = level(var(c[i]));
+        if (l > highest)
+            highest = l, highest_i = i, one = true;
+        else if (l == highest)
+            one = false;
+    }
+
+    if (highest_i != 0) {
+        Lit p = c[0];
+        c[0] = c[highest_i], c[highest_i] = p;
+        if (highest_i > 1) {
+            if (c.size() == 3) {
+                remove(watchesTer[~p], TernaryWatcher(confl, c[1], c[2]));
+                watchesTer[~c[0]].push(TernaryWatcher(confl, c[1], c[2]));
+            } else {
+                remove(watches[~p], Watcher(confl, c[1]));
+                watches[~c[0]].push(Watcher(confl, c[1]));
+            }
+        }
+    }
+
+    if (one && highest > 0) {
+        // The highest level of the other literals is watched by 'c[1]' and 'c[0]' is implied there:
+        int second_i = 1;
+        for (int i = 2; i < c.size(); i++)
+            if (level(var(c[i])) > level(var(c[second_i])))
+                second_i = i;
+        if (second_i != 1) {
+            Lit p = c[1];
+            c[1] = c[second_i], c[second_i] = p;
+            if (c.size() == 3) {
+                remove(watchesTer[~p], TernaryWatcher(confl, c[0], c[2]));
+                watchesTer[~c[1]].push(TernaryWatcher(confl, c[0], c[2]));
+            } else {
+                remove(watches[~p], Watcher(confl, c[0]));
+                watches[~c[1]].push(Watcher(confl, c[0]));
+            }
+        }
+        cancelUntil(highest - 1);
+        uncheckedEnqueue(c[0], level(var(c[1])), confl);
+        return -1;
+    }
+    return highest;
+}
+
 
 //=================================================================================================
 // Major methods:
@@ -669,8 +844,11 @@ Lit Solver::pickBranchLit() {
 |  
 |________________________________________________________________________________________________@*/
 void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& out_btlevel,unsigned int &lbd,unsigned int &szWithoutSelectors) {
+    PROFILE_PHASE(PROF_ANALYZE);
     int pathC = 0;
     Lit p = lit_Undef;
+    // The conflict may be below the current decision level (see 'conflictLevel()'):
+    int conflLevel = chrono >= 0 ? level(var(ca[confl][0])) : decisionLevel();
 
 
     // Generate conflict clause:
@@ -692,6 +870,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& o
         if (c.learnt()) {
             parallelImportClauseDuringConflictAnalysis(c,confl);
             claBumpActivity(c);
+            c.setUsed(true);
          } else { // original clause
             if (!c.getSeen()) {
                 originalClausesSeen++;
@@ -708,6 +887,11 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& o
                 }
                 // seems to be interesting : keep it for the next round
                 c.setLBD(nblevels); // Update it
+                unsigned int tier = nblevels <= coreLBD ? CORE : nblevels <= tier2LBD ? TIER2 : LOCAL;
+                if (tier > c.tier()) {
+                    c.setTier(tier);
+                    nbPromotedTier++;
+                }
             }
         }
 
@@ -722,7 +906,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& o
                         // varBumpActivity(var(q));
                     conflicted[var(q)] = conflicts;
                     seen[var(q)] = 1;
-                    if (level(var(q)) >= decisionLevel()) {
+                    if (level(var(q)) >= conflLevel) {
                         pathC++;
                     } else {
                         if(isSelector(var(q))) {
@@ -735,9 +919,11 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& o
             }
         }
 
-        // Select next clause to look at:
-        while (!seen[var(trail[index--])]);
-        p = trail[index + 1];
+        // Select next clause to look at (skipping the lower levels out of order on the trail):
+        do {
+            while (!seen[var(trail[index--])]);
+            p = trail[index + 1];
+        } while (level(var(p)) < conflLevel);
         confl = reason(var(p));
         seen[var(p)] = 0;
         pathC--;
@@ -753,33 +939,36 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt,vec<Lit>&selectors, int& o
         out_learnt.push(selectors[i]);
 
     out_learnt.copyTo(analyze_toclear);
-    if (ccmin_mode == 2) {
-        uint32_t abstract_level = 0;
-        for (i = 1; i < out_learnt.size(); i++)
-            abstract_level |= abstractLevel(var(out_learnt[i])); // (maintain an abstraction of levels involved in conflict)
-
-        for (i = j = 1; i < out_learnt.size(); i++)
-            if (reason(var(out_learnt[i])) == CRef_Undef || !litRedundant(out_learnt[i], abstract_level))
-                out_learnt[j++] = out_learnt[i];
-
-    } else if (ccmin_mode == 1) {
-        for (i = j = 1; i < out_learnt.size(); i++) {
-            Var x = var(out_learnt[i]);
-
-            if (reason(x) == CRef_Undef)
-                out_learnt[j++] = out_learnt[i];
-            else {
-                Clause& c = ca[reason(var(out_learnt[i]))];
-                // Thanks to Siert Wieringa for this bug fix!
-                for (int k = ((c.size() == 2) ? 0 : 1); k < c.size(); k++)
-                    if (!seen[var(c[k])] && level(var(c[k])) > 0) {
-                        out_learnt[j++] = out_learnt[i];
-                        break;
-                    }
+    { // (conflict clause minimization)
+        PROFILE_PHASE(PROF_MINIMIZE);
+        if (ccmin_mode == 2) {
+            uint32_t abstract_level = 0;
+            for (i = 1; i < out_learnt.size(); i++)
+                abstract_level |= abstractLevel(var(out_learnt[i])); // (maintain an abstraction of levels involved in conflict)
+
+            for (i = j = 1; i < out_learnt.size(); i++)
+                if (reason(var(out_learnt[i])) == CRef_Undef || !litRedundant(out_learnt[i], abstract_level))
+                    out_learnt[j++] = out_learnt[i];
+
+        } else if (ccmin_mode == 1) {
+            for (i = j = 1; i < out_learnt.size(); i++) {
+                Var x = var(out_learnt[i]);
+
+                if (reason(x) == CRef_Undef)
+                    out_learnt[j++] = out_learnt[i];
+                else {
+                    Clause& c = ca[reason(var(out_learnt[i]))];
+                    // Thanks to Siert Wieringa for this bug fix!
+                    for (int k = ((c.size() == 2) ? 0 : 1); k < c.size(); k++)
+                        if (!seen[var(c[k])] && level(var(c[k])) > 0) {
+                            out_learnt[j++] = out_learnt[i];
+                            break;
+                        }
+                }
             }
-        }
-    } else
-        i = j = out_learnt.size();
+        } else
+            i = j = out_learnt.size();
+    }
 
     max_literals += out_learnt.size();
     out_learnt.shrink(i - j);
@@ -916,6 +1105,13 @@ void Solver::uncheckedEnqueue(Lit p, CRef from) {
     trail.push_(p);
 }
 
+void Solver::uncheckedEnqueue(Lit p, int level, CRef from) {
+    assert(value(p) == l_Undef);
+    assigns[var(p)] = lbool(!sign(p));
+    vardata[var(p)] = mkVarData(from, level);
+    trail.push_(p);
+}
+
 /*_________________________________________________________________________________________________
 |
 |  propagate : [void]  ->  [Clause*]
@@ -928,14 +1124,17 @@ void Solver::uncheckedEnqueue(Lit p, CRef from) {
 |      * the propagation queue is empty, even if there was a conflict.
 |________________________________________________________________________________________________@*/
 CRef Solver::propagate() {
+    PROFILE_PHASE(PROF_PROPAGATE);
     CRef confl = CRef_Undef;
     int num_props = 0;
     int previousqhead = qhead;
     watches.cleanAll();
     watchesBin.cleanAll();
+    watchesTer.cleanAll();
     unaryWatches.cleanAll();
     while (qhead < trail.size()) {
         Lit p = trail[qhead++]; // 'p' is enqueued fact to propagate.
+        int p_level = level(var(p)); // (below the decision level only out of order, see 'chrono')
         vec<Watcher>& ws = watches[p];
         Watcher *i, *j, *end;
         num_props++;
@@ -943,6 +1142,7 @@ CRef Solver::propagate() {
 
         // First, Propagate binary clauses 
         vec<Watcher>& wbin = watchesBin[p];
+        PROFILE(profile.watchLength(PROF_BINARY, wbin.size()));
 
         for (int k = 0; k < wbin.size(); k++) {
 
@@ -953,11 +1153,63 @@ CRef Solver::propagate() {
             }
 
             if (value(imp) == l_Undef) {
-                uncheckedEnqueue(imp, wbin[k].cref);
+                uncheckedEnqueue(imp, p_level, wbin[k].cref);
             }
         }
 
+        // Then ternary clauses: the watcher holds both other literals, so the clause is only looked
+        // at when it is neither satisfied by one of them nor can keep its watch on 'p'
+        vec<TernaryWatcher>& wter = watchesTer[p];
+        TernaryWatcher *ti, *tj, *tend;
+        PROFILE(profile.watchLength(PROF_TERNARY, wter.size()));
+
+        for (ti = tj = (TernaryWatcher*) wter, tend = ti + wter.size(); ti != tend;) {
+            if (value(ti->other1) == l_True || value(ti->other2) == l_True) {
+                *tj++ = *ti++;
+                continue;
+            }
+
+            // Make sure the false literal is data[1]:
+            CRef cr = ti->cref;
+            Clause& c = ca[cr];
+            PROFILE(profile.ternary_visits++);
+            Lit false_lit = ~p;
+            if (c[0] == false_lit)
+                c[0] = c[1], c[1] = false_lit;
+            assert(c[1] == false_lit);
+
+            // Move the watch to the third literal if it is not false:
+            if (value(c[2]) != l_False) {
+                c[1] = c[2], c[2] = false_lit;
+                watchesTer[~c[1]].push(TernaryWatcher(cr, c[0], false_lit));
+                ti++;
+                continue;
+            }
+
+            if (value(c[0]) == l_False) {
+                *tj++ = *ti++;
+                confl = cr;
+                qhead = trail.size();
+                // Copy the remaining watches:
+                while (ti < tend)
+                    *tj++ = *ti++;
+            } else if (p_level != decisionLevel() && level(var(c[2])) > p_level) {
+                // Out of order (see 'chrono'): watch the literal of the highest level
+                c[1] = c[2], c[2] = false_lit;
+                watchesTer[~c[1]].push(TernaryWatcher(cr, c[0], false_lit));
+                ti++;
+                uncheckedEnqueue(c[0], level(var(c[1])), cr);
+            } else {
+                *tj++ = *ti++;
+                uncheckedEnqueue(c[0], p_level, cr);
+            }
+        }
+        wter.shrink(ti - tj);
+        if (confl != CRef_Undef)
+            break;
+
         // Now propagate other 2-watched clauses
+        PROFILE(profile.watchLength(PROF_LONG, ws.size()));
         for (i = j = (Watcher*) ws, end = i + ws.size(); i != end;) {
             // Try to avoid inspecting the clause:
             Lit blocker = i->blocker;
@@ -969,6 +1221,7 @@ CRef Solver::propagate() {
             // Make sure the false literal is data[1]:
             CRef cr = i->cref;
             Clause& c = ca[cr];
+            PROFILE(profile.clause_visits[c.learnt() ? 1 + c.tier() : 0]++);
             assert(!c.getOneWatched());
             Lit false_lit = ~p;
             if (c[0] == false_lit)
@@ -1024,10 +1277,21 @@ CRef Solver::propagate() {
                 // Copy the remaining watches:
                 while (i < end)
                     *j++ = *i++;
-            } else {
+            } else if (p_level == decisionLevel()) {
                 uncheckedEnqueue(first, cr);
-
-
+            } else {
+                // Out of order (see 'chrono'): the implication is at the highest level of the
+                // other literals, one of which takes over the watch
+                int max_k = 1;
+                for (int k = 2; k < c.size(); k++)
+                    if (level(var(c[k])) > level(var(c[max_k])))
+                        max_k = k;
+                if (max_k != 1) {
+                    c[1] = c[max_k], c[max_k] = false_lit;
+                    j--;
+                    watches[~c[1]].push(w);
+                }
+                uncheckedEnqueue(first, level(var(c[1])), cr);
             }
 NextClause:
             ;
@@ -1140,45 +1404,207 @@ NextClauseUnary:
 |  reduceDB : ()  ->  [void]
 |  
 |  Description:
-|    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
-|    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    Learnt clauses are in three tiers, by the best LBD they had: core clauses (binary or LBD up to
+|    'coreLBD') are never removed, tier-2 clauses (LBD up to 'tier2LBD') go down to the local tier
+|    when they were not used in conflict analysis since the last reduction. The worst clauses of
+|    the local tier, as many as half of the learnt clauses, are removed, minus the clauses locked by
+|    the current assignment. Locked clauses are clauses that are reason to some assignment. The
+|    worst clauses are selected, not sorted.
 |________________________________________________________________________________________________@*/
 
 
 void Solver::reduceDB()
 {
- 
+  PROFILE_PHASE(PROF_REDUCEDB);
   int     i, j;
   nbReduceDB++;
-  sort(learnts, reduceDB_lt(ca));
-
-  // We have a lot of "good" clauses, it is difficult to compare them. Keep more !
-  if(ca[learnts[learnts.size() / RATIOREMOVECLAUSES]].lbd()<=3) nbclausesbeforereduce +=specialIncReduceDB; 
-  // Useless :-)
-  if(ca[learnts.last()].lbd()<=5)  nbclausesbeforereduce +=specialIncReduceDB; 
-  
-  
-  // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
-  // Keep clauses which seem to be usefull (their lbd was reduce during this sequence)
 
-  int limit = learnts.size() / 2;
-
-  for (i = j = 0; i < learnts.size(); i++){
+  nbCoreLearnts = nbTier2Learnts = nbLocalLearnts = 0;
+  unsigned int best_lbd = UINT32_MAX;
+  int above3 = 0;
+  reduce_local.clear();
+  for (i = 0; i < learnts.size(); i++){
     Clause& c = ca[learnts[i]];
-    if (c.lbd()>2 && c.size() > 2 && c.canBeDel() &&  !locked(c) && (i < limit)) {
-      removeClause(learnts[i]);
-      nbRemovedClauses++;
+    if (c.tier() == TIER2 && !c.used()) {
+      c.setTier(LOCAL);
+      nbDemotedTier++;
     }
+    c.setUsed(false);
+    if (c.lbd() < best_lbd) best_lbd = c.lbd();
+    if (c.lbd() > 3) above3++;
+
+    if (c.tier() == CORE) nbCoreLearnts++;
+    else if (c.tier() == TIER2) nbTier2Learnts++;
     else {
-      if(!c.canBeDel()) limit++; //we keep c, so we can delete an other clause
+      nbLocalLearnts++;
+      // Keep clauses which seem to be usefull (their lbd was reduce during this sequence)
+      if (c.canBeDel() && !locked(c)) reduce_local.push(learnts[i]);
       c.setCanBeDel(true);       // At the next step, c can be delete
-      learnts[j++] = learnts[i];
     }
   }
+
+  // Delete the worst clauses of the local tier (highest LBD, then lowest activity), as many as half
+  // of the learnt clauses
+  int limit = learnts.size() / RATIOREMOVECLAUSES;
+  if (limit > reduce_local.size()) limit = reduce_local.size();
+  select(reduce_local, limit, reduceDB_lt(ca));
+
+  // We have a lot of "good" clauses, it is difficult to compare them. Keep more !
+  // (the median LBD is at most 3)
+  if (above3 <= learnts.size() / RATIOREMOVECLAUSES) nbclausesbeforereduce += specialIncReduceDB;
+  // Useless :-)
+  if (best_lbd <= 5)  nbclausesbeforereduce +=specialIncReduceDB; 
+
+  for (i = 0; i < limit; i++) {
+    removeClause(reduce_local[i]);
+    nbRemovedClauses++;
+  }
+  nbLocalLearnts -= limit;
+
+  for (i = j = 0; i < learnts.size(); i++)
+    if (ca[learnts[i]].mark() != 1)
+      learnts[j++] = learnts[i];
   learnts.shrink(i - j);
   checkGarbage();
 }
 
+/*_________________________________________________________________________________________________
+|
+|  vivifyLearnts : [void]  ->  [bool]
+|  
+|  Description:
+|    Vivify the core and tier-2 learnt clauses that were not vivified yet, best first. The literals
+|    of a clause are falsified one by one (the clause itself detached): a literal already false is
+|    redundant, and the clause is cut after a true literal or at a conflict. The shorter clause is
+|    implied by unit propagation, it replaces the clause in place. The propagations are bounded by
+|    'vivify_eff' times the ones of the search since the last vivification.
+|  
+|  Output:
+|    FALSE if the clause set is found unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool Solver::vivifyLearnts() {
+    assert(decisionLevel() == 0);
+
+    nbVivifyRounds++;
+    next_vivify = conflicts + vivify_confl;
+    int64_t budget = (int64_t) ((propagations - vivify_props) * vivify_eff);
+    int saved_phase_saving = phase_saving;
+    phase_saving = 0; // (the assignments of the vivification are not phases)
+
+    vivify_cands.clear();
+    for (int i = 0; i < learnts.size(); i++) {
+        const Clause& c = ca[learnts[i]];
+        if (c.tier() != LOCAL && !c.vivified() && c.size() > 2)
+            vivify_cands.push(learnts[i]);
+    }
+    sort(vivify_cands, vivify_lt(ca));
+
+    bool removed = false;
+    for (int n = 0; n < vivify_cands.size() && ok && budget > 0; n++) {
+        CRef cr = vivify_cands[n];
+        Clause& c = ca[cr];
+        c.setVivified(true);
+        if (satisfied(c)) continue;
+
+        detachClause(cr, true);
+        vivify_lits.clear();
+        CRef confl = CRef_Undef;
+        for (int i = 0; i < c.size(); i++) {
+            Lit p = c[i];
+            if (value(p) == l_False) continue;
+            vivify_lits.push(p);
+            if (value(p) == l_True) {
+                confl = reason(var(p));
+                break;
+            }
+            newDecisionLevel();
+            uncheckedEnqueue(~p);
+            if ((confl = propagate()) != CRef_Undef) break;
+        }
+        if (decisionLevel() > 0)
+            budget -= trail.size() - trail_lim[0]; // ('propagations' misses the binary conflicts)
+
+        if (vivify_lits.size() == c.size()) {
+            cancelUntil(0);
+            attachClause(cr);
+            continue;
+        }
+
+        nbVivified++;
+        nbVivifiedLits += c.size() - vivify_lits.size();
+        uint64_t id = 0;
+        if (traceProof) {
+            // Without a conflict or a true literal, the literals left out are resolved from 'c'
+            traceChain(confl != CRef_Undef ? confl : cr, vivify_lits, vivify_lits.size(), trace_chain);
+            id = ++nextClauseId;
+            traceClause(id, vivify_lits, vivify_lits.size(), trace_chain);
+        }
+        if (certifiedUNSAT) {
+            for (int i = 0; i < vivify_lits.size(); i++)
+                fprintf(certifiedOutput, "%i ", (var(vivify_lits[i]) + 1) * (-2 * sign(vivify_lits[i]) + 1));
+            fprintf(certifiedOutput, "0\n");
+        }
+        cancelUntil(0);
+
+        if (vivify_lits.size() == 1) {
+            attachClause(cr); // ('removeClause()' detaches it again and updates the literal counts)
+            removeClause(cr);
+            removed = true;
+            if (traceProof) unitIds[var(vivify_lits[0])] = id;
+            uncheckedEnqueue(vivify_lits[0]);
+            if ((confl = propagate()) != CRef_Undef) {
+                if (traceProof) traceEmpty(confl);
+                ok = false;
+            }
+            continue;
+        }
+
+        if (certifiedUNSAT) {
+            fprintf(certifiedOutput, "d ");
+            for (int i = 0; i < c.size(); i++)
+                fprintf(certifiedOutput, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
+            fprintf(certifiedOutput, "0\n");
+        }
+        if (traceProof) clauseIds[cr] = id;
+        for (int i = 0; i < vivify_lits.size(); i++)
+            c[i] = vivify_lits[i];
+        c.shrink(c.size() - vivify_lits.size());
+        c.setSizeWithoutSelectors(c.size());
+        if (c.lbd() > (unsigned int) c.size()) c.setLBD(c.size());
+        unsigned int tier = c.size() == 2 || c.lbd() <= coreLBD ? CORE : c.lbd() <= tier2LBD ? TIER2 : LOCAL;
+        if (tier > c.tier()) {
+            c.setTier(tier);
+            nbPromotedTier++;
+        }
+        attachClause(cr);
+    }
+
+    phase_saving = saved_phase_saving;
+    vivify_props = propagations;
+
+    if (removed) {
+        int i, j;
+        for (i = j = 0; i < learnts.size(); i++)
+            if (ca[learnts[i]].mark() != 1)
+                learnts[j++] = learnts[i];
+        learnts.shrink(i - j);
+    }
+    checkGarbage();
+    return ok;
+}
+
+
+// Inprocessing between two restarts (see also 'SimpSolver::inprocess()'). Returns FALSE if the
+// clause set is found unsatisfiable.
+
+bool Solver::inprocess() {
+    if (vivify_confl > 0 && conflicts >= next_vivify) {
+        cancelUntil(0);
+        return vivifyLearnts();
+    }
+    return true;
+}
+
 
 void Solver::removeSatisfied(vec<CRef>& cs) {
 
@@ -1222,6 +1648,7 @@ bool Solver::simplify() {
     else {
         CRef cr = propagate();
         if (cr != CRef_Undef) {
+            if (traceProof) traceEmpty(cr);
             return ok = false;
         }
     }
@@ -1305,13 +1732,23 @@ lbool Solver::search(int nof_conflicts) {
            if (step_size > min_step_size)
                 step_size -= step_size_dec;
 
+#ifdef PROFILE_COUNTERS
+            if (profileOutput != NULL && profile_every > 0 && conflicts % profile_every == 0)
+                writeProfile();
+#endif
             if (verbosity >= 1 && conflicts % verbEveryConflicts == 0) {
                 printf("c | %8d   %7d    %5d | %7d %8d %8d | %5d %8d   %6d %8d | %6.3f %% |\n",
                         (int) starts, (int) nbstopsrestarts, (int) (conflicts / starts),
                         (int) dec_vars - (trail_lim.size() == 0 ? trail.size() : trail_lim[0]), nClauses(), (int) clauses_literals,
                         (int) nbReduceDB, nLearnts(), (int) nbDL2, (int) nbRemovedClauses, progressEstimate()*100);
             }
-            if (decisionLevel() == 0) {
+            int conflLevel = decisionLevel();
+            if (chrono >= 0 && conflLevel > 0 && (conflLevel = conflictLevel(confl)) < 0) {
+                action = trail.size();
+                continue;
+            }
+            if (conflLevel == 0) {
+                if (traceProof) traceEmpty(confl);
                 return l_False;
 
             }
@@ -1336,11 +1773,23 @@ lbool Solver::search(int nof_conflicts) {
             lbdQueue.push(nblevels);
             sumLBD += nblevels;
 
-            cancelUntil(backtrack_level);
+            uint64_t id = 0;
+            if (traceProof) {
+                traceChain(confl, learnt_clause, learnt_clause.size(), trace_chain);
+                id = ++nextClauseId;
+                traceClause(id, learnt_clause, learnt_clause.size(), trace_chain);
+            }
+
+            if (chrono >= 0 && conflicts >= (uint64_t) confl_to_chrono && decisionLevel() - backtrack_level >= chrono) {
+                nbChronoBacktracks++;
+                cancelUntil(conflLevel - 1);
+            } else
+                cancelUntil(backtrack_level);
 
             action = trail.size();
 
             if (certifiedUNSAT) {
+                PROFILE_PHASE(PROF_PROOF);
                 for (int i = 0; i < learnt_clause.size(); i++)
                     fprintf(certifiedOutput, "%i ", (var(learnt_clause[i]) + 1) *
                         (-2 * sign(learnt_clause[i]) + 1));
@@ -1349,12 +1798,15 @@ lbool Solver::search(int nof_conflicts) {
 
 
             if (learnt_clause.size() == 1) {
-                uncheckedEnqueue(learnt_clause[0]);
+                if (traceProof) unitIds[var(learnt_clause[0])] = id;
+                uncheckedEnqueue(learnt_clause[0], 0, CRef_Undef);
                 nbUn++;
                 parallelExportUnaryClause(learnt_clause[0]);
             } else {
                 CRef cr = ca.alloc(learnt_clause, true);
+                if (traceProof) clauseIds.insert(cr, id);
                 ca[cr].setLBD(nblevels);
+                ca[cr].setTier(nblevels <= coreLBD || ca[cr].size() == 2 ? CORE : nblevels <= tier2LBD ? TIER2 : LOCAL);
                 ca[cr].setOneWatched(false);
 		ca[cr].setSizeWithoutSelectors(szWithoutSelectors);
                 if (nblevels <= 2) nbDL2++; // stats
@@ -1364,7 +1816,7 @@ lbool Solver::search(int nof_conflicts) {
                 lastLearntClause = cr; // Use in multithread (to hard to put inside ParallelSolver)
                 parallelExportClauseDuringSearch(ca[cr]);
                 claBumpActivity(ca[cr]);
-                uncheckedEnqueue(learnt_clause[0], cr);
+                uncheckedEnqueue(learnt_clause[0], backtrack_level, cr);
 
             }
             //varDecayActivity();
@@ -1380,6 +1832,12 @@ lbool Solver::search(int nof_conflicts) {
                 int bt = 0;
                 if(incremental) // DO NOT BACKTRACK UNTIL 0.. USELESS
                     bt = (decisionLevel()<assumptions.size()) ? decisionLevel() : assumptions.size();
+                if (reuse_trail) {
+                    int bt0 = bt;
+                    bt = reuseTrail(bt);
+                    if (bt > bt0) // (the literals of the levels kept above 'bt0')
+                        nbReusedTrail += (bt < decisionLevel() ? trail_lim[bt] : trail.size()) - trail_lim[bt0];
+                }
                 cancelUntil(bt);
                 return l_Undef;
             }
@@ -1436,6 +1894,27 @@ lbool Solver::search(int nof_conflicts) {
     }
 }
 
+// Partial restart (van der Tak, Ramos and Heule, "Reusing the assignment trail in CDCL solvers"):
+// the decisions more active than the variable to be picked next would be taken again after a
+// restart, so the levels above 'level' that only hold such decisions are kept.
+
+int Solver::reuseTrail(int level) {
+    Var next = var_Undef;
+    while (!order_heap.empty()) {
+        next = order_heap[0];
+        if (value(next) == l_Undef && decision[next])
+            break;
+        order_heap.removeMin();
+        next = var_Undef;
+    }
+    if (next == var_Undef)
+        return level;
+
+    while (level < decisionLevel() && activity[var(trail[trail_lim[level]])] > activity[next])
+        level++;
+    return level;
+}
+
 double Solver::progressEstimate() const {
     double progress = 0;
     double F = 1.0 / nVars();
@@ -1478,6 +1957,10 @@ lbool Solver::solve_(bool do_simp, bool turn_off_simp) // Parameters are useless
     printf("Can not use incremental and certified unsat in the same time\n");
     exit(-1);
   }
+    if(incremental && traceProof) {
+    printf("Can not use incremental and resolution trace in the same time\n");
+    exit(-1);
+  }
  
     model.clear();
     conflict.clear();
@@ -1512,6 +1995,10 @@ lbool Solver::solve_(bool do_simp, bool turn_off_simp) // Parameters are useless
     // Search:
     int curr_restarts = 0;
     while (status == l_Undef){
+      if (!incremental && !inprocess()) {
+          status = l_False;
+          break;
+      }
       status = search(0); // the parameter is useless in glucose, kept to allow modifications
 
         if (!withinBudget()) break;
@@ -1632,6 +2119,134 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps) {
 }
 
 
+//=================================================================================================
+// Resolution trace:
+//
+// Clauses are written as 'id literals 0 antecedents 0', input clauses without antecedents. The
+// antecedents of a derived clause are listed so that each one is unit (or, the last, conflicting)
+// under the negation of the clause and the ones before it: the unit clauses of top-level
+// assignments first, then the reasons resolved by 'analyze()' and 'litRedundant()' (and the
+// binary clauses of 'minimisationWithBinaryResolution()'), each after the reasons of its
+// literals, then the conflict.
+
+uint64_t Solver::clauseId(CRef cr) {
+    uint64_t id = 0;
+    clauseIds.peek(cr, id);
+    assert(id != 0);
+    return id;
+}
+
+uint64_t Solver::unitId(Var v) {
+    if (unitIds[v] == 0) traceUnits();
+    if (unitIds[v] == 0) traceUnit(v); // (above the first decision, see 'chrono')
+    assert(unitIds[v] != 0);
+    return unitIds[v];
+}
+
+void Solver::traceClause(uint64_t id, const Lit* lits, int size, const vec<uint64_t>& hints) {
+    PROFILE_PHASE(PROF_PROOF);
+    fprintf(traceOutput, "%" PRIu64" ", id);
+    for (int i = 0; i < size; i++)
+        fprintf(traceOutput, "%i ", (var(lits[i]) + 1) * (-2 * sign(lits[i]) + 1));
+    fprintf(traceOutput, "0 ");
+    for (int i = 0; i < hints.size(); i++)
+        fprintf(traceOutput, "%" PRIu64" ", hints[i]);
+    fprintf(traceOutput, "0\n");
+}
+
+// Top-level assignments implied by a clause become unit clauses of their own, resolved from the
+// reason and the unit clauses of its other literals (which are earlier on the trail).
+
+void Solver::traceUnits() {
+    int end = decisionLevel() == 0 ? trail.size() : trail_lim[0];
+    for (; unitsTraced < end; unitsTraced++) {
+        Lit p = trail[unitsTraced];
+        if (unitIds[var(p)] == 0) traceUnit(var(p));
+    }
+}
+
+// After a chronological backtrack top-level assignments can also be above 'trail_lim[0]', where
+// 'traceUnits()' does not reach: the unit clauses of their reasons are then written first.
+
+void Solver::traceUnit(Var v) {
+    assert(level(v) == 0 && reason(v) != CRef_Undef);
+    Clause& c = ca[reason(v)];
+    vec<uint64_t> hints;
+    for (int i = 0; i < c.size(); i++)
+        if (var(c[i]) != v) {
+            if (unitIds[var(c[i])] == 0) traceUnit(var(c[i]));
+            hints.push(unitIds[var(c[i])]);
+        }
+    hints.push(clauseId(reason(v)));
+
+    Lit p = mkLit(v, value(v) == l_False);
+    unitIds[v] = ++nextClauseId;
+    traceClause(unitIds[v], &p, 1, hints);
+}
+
+// The literals of 'c' assigned above level 0 are the leaves; every other false literal reached
+// from the conflict is resolved away with its reason, or with its unit clause at level 0. (A leaf
+// is true when 'confl' is its reason, see 'vivifyLearnts()'.)
+
+void Solver::traceChain(CRef confl, const Lit* c, int size, vec<uint64_t>& out) {
+    out.clear();
+    trace_units.clear();
+    for (int i = 0; i < size; i++) {
+        Var x = var(c[i]);
+        if (value(c[i]) != l_Undef && level(x) > 0 && !seen[x]) {
+            seen[x] = 1;
+            trace_toclear.push(x);
+        }
+    }
+    for (int i = 0; i < trace_bin.size(); i++) {
+        Var x = var(trace_bin[i].blocker);
+        seen[x] = 1;
+        trace_toclear.push(x);
+        out.push(clauseId(trace_bin[i].cref));
+    }
+    trace_bin.clear();
+
+    TraceFrame f = { confl, 0 };
+    trace_stack.push(f);
+    while (trace_stack.size() > 0) {
+        TraceFrame& top = trace_stack.last();
+        const Clause& r = ca[top.cref];
+        if (top.next == r.size()) {
+            out.push(clauseId(top.cref));
+            trace_stack.pop();
+            continue;
+        }
+
+        Var x = var(r[top.next++]);
+        if (seen[x]) continue;
+        seen[x] = 1;
+        trace_toclear.push(x);
+        if (level(x) == 0)
+            trace_units.push(x);
+        else {
+            assert(reason(x) != CRef_Undef);
+            TraceFrame g = { reason(x), 0 };
+            trace_stack.push(g);
+        }
+    }
+
+    for (int i = 0; i < trace_toclear.size(); i++) seen[trace_toclear[i]] = 0;
+    trace_toclear.clear();
+
+    // Units go first:
+    for (int i = 0; i < trace_units.size(); i++) trace_units[i] = unitId((Var)trace_units[i]);
+    int n = out.size();
+    out.growTo(n + trace_units.size());
+    for (int i = n - 1; i >= 0; i--) out[i + trace_units.size()] = out[i];
+    for (int i = 0; i < trace_units.size(); i++) out[i] = trace_units[i];
+}
+
+void Solver::traceEmpty(CRef confl) {
+    traceChain(confl, NULL, 0, trace_chain);
+    traceClause(++nextClauseId, NULL, 0, trace_chain);
+}
+
+
 //=================================================================================================
 // Garbage Collection methods:
 
@@ -1641,6 +2256,7 @@ void Solver::relocAll(ClauseAllocator& to) {
     // for (int i = 0; i < watches.size(); i++)
     watches.cleanAll();
     watchesBin.cleanAll();
+    watchesTer.cleanAll();
     unaryWatches.cleanAll();
     for (int v = 0; v < nVars(); v++)
         for (int s = 0; s < 2; s++) {
@@ -1652,6 +2268,9 @@ void Solver::relocAll(ClauseAllocator& to) {
             vec<Watcher>& ws2 = watchesBin[p];
             for (int j = 0; j < ws2.size(); j++)
                 ca.reloc(ws2[j].cref, to);
+            vec<TernaryWatcher>& wst = watchesTer[p];
+            for (int j = 0; j < wst.size(); j++)
+                ca.reloc(wst[j].cref, to);
             vec<Watcher>& ws3 = unaryWatches[p];
             for (int j = 0; j < ws3.size(); j++)
                 ca.reloc(ws3[j].cref, to);
@@ -1678,15 +2297,54 @@ void Solver::relocAll(ClauseAllocator& to) {
 
     for (int i = 0; i < unaryWatchedClauses.size(); i++)
         ca.reloc(unaryWatchedClauses[i], to);
+
+    // Clause IDs:
+    //
+    if (traceProof) {
+        Map<CRef,uint64_t,CRefHash> ids;
+        for (int i = 0; i < clauseIds.bucket_count(); i++)
+            for (int j = 0; j < clauseIds.bucket(i).size(); j++) {
+                CRef cr = clauseIds.bucket(i)[j].key;
+                if (ca[cr].reloced())
+                    ids.insert(ca[cr].relocation(), clauseIds.bucket(i)[j].data);
+            }
+        ids.moveTo(clauseIds);
+    }
 }
 
 
 
+#ifdef PROFILE_COUNTERS
+void Solver::writeProfile() {
+    FILE* out = profileOutput;
+    if (out == stdout) fprintf(out, "c profile ");
+    fprintf(out, "{\"conflicts\": %" PRIu64", \"propagations\": %" PRIu64", \"cpu_time\": %g, \"phases\": {",
+        conflicts, propagations, cpuTime());
+    for (int i = 0; i < PROF_NB_PHASES; i++)
+        fprintf(out, "%s\"%s\": {\"calls\": %" PRIu64", \"cycles\": %" PRIu64"}", i > 0 ? ", " : "",
+            profile_phases[i], profile.calls[i], profile.cycles[i]);
+    fprintf(out, "}, \"watch_lengths\": {");
+    for (int i = 0; i < PROF_NB_WATCHES; i++) {
+        fprintf(out, "%s\"%s\": [", i > 0 ? ", " : "", profile_watches[i]);
+        for (int b = 0; b < Profile::NB_BUCKETS; b++)
+            fprintf(out, "%s%" PRIu64, b > 0 ? ", " : "", profile.watch_lengths[i][b]);
+        fprintf(out, "]");
+    }
+    fprintf(out, "}, \"clause_visits\": {\"original\": %" PRIu64", \"core\": %" PRIu64", \"tier2\": %" PRIu64", \"local\": %" PRIu64", \"ternary\": %" PRIu64"}}\n",
+        profile.clause_visits[0], profile.clause_visits[1 + CORE], profile.clause_visits[1 + TIER2], profile.clause_visits[1 + LOCAL],
+        profile.ternary_visits);
+    fflush(out);
+}
+#endif
+
+
 void Solver::garbageCollect() {
+    PROFILE_PHASE(PROF_GC);
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted());
 
+    if (traceProof) traceUnits(); // (before the reasons of top-level assignments are moved)
     relocAll(to);
     if (verbosity >= 2)
         printf("|  Garbage collection:   %12d bytes => %12d bytes             |\n",
@@ -56,6 +56,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "core/SolverTypes.h"
 #include "core/BoundedQueue.h"
 #include "core/Constants.h"
+#include "core/Profile.h"
 #include "mtl/Clone.h"
 
 
@@ -181,6 +182,13 @@ public:
     int          incReduceDB;
     int          specialIncReduceDB;
     unsigned int lbLBDFrozenClause;
+    unsigned int coreLBD;          // Learnt clauses up to this LBD are never deleted.
+    unsigned int tier2LBD;         // Learnt clauses up to this LBD are kept while they are used.
+    int          vivify_confl;     // Conflicts between two vivifications of the learnt clauses (0=never).
+    double       vivify_eff;       // Propagations of a vivification, relative to the ones of the search since the last one.
+
+    // Tiers of the learnt clause database:
+    enum { LOCAL = 0, TIER2 = 1, CORE = 2 };
 
     // Constant for reducing clause
     int          lbSizeMinimizingClause;
@@ -195,6 +203,9 @@ public:
     double    random_seed;
     int       ccmin_mode;         // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
     int       phase_saving;       // Controls the level of phase saving (0=none, 1=limited, 2=full).
+    int       chrono;             // Backjumps over more levels than this backtrack chronologically instead (-1=never).
+    int       confl_to_chrono;    // Number of conflicts before backtracking chronologically.
+    bool      reuse_trail;        // Restarts keep the levels of the decisions more active than the next one.
     bool      rnd_pol;            // Use random polarities for branching heuristics.
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     
@@ -205,6 +216,20 @@ public:
     FILE*               certifiedOutput;
     bool                certifiedUNSAT;
 
+    // Resolution trace (TraceCheck format): every clause gets an ID, every derived clause is
+    // written with the IDs of the clauses it was resolved from
+    FILE*               traceOutput;
+    bool                traceProof;
+
+#ifdef PROFILE_COUNTERS
+    // Hot-path counters (see 'Profile.h'), written to 'profileOutput' (which may be 'stdout') at
+    // the end and every 'profile_every' conflicts
+    Profile             profile;
+    FILE*               profileOutput;
+    int                 profile_every;
+    void                writeProfile();
+#endif
+
     // Panic mode. 
     // Save memory
     uint32_t panicModeLastRemoved, panicModeLastRemovedShared;
@@ -230,7 +255,9 @@ public:
     uint64_t    originalClausesSeen; // Number of original clauses seen
     uint64_t    sumDecisionLevels;
     //
-    uint64_t nbRemovedClauses,nbRemovedUnaryWatchedClauses, nbReducedClauses,nbDL2,nbBin,nbUn,nbReduceDB,solves, starts, decisions, rnd_decisions, propagations, conflicts,conflictsRestarts,nbstopsrestarts,nbstopsrestartssame,lastblockatrestart;
+    uint64_t nbRemovedClauses,nbRemovedUnaryWatchedClauses, nbReducedClauses,nbDL2,nbBin,nbUn,nbReduceDB,solves, starts, decisions, rnd_decisions, propagations, conflicts,conflictsRestarts,nbstopsrestarts,nbstopsrestartssame,lastblockatrestart,nbChronoBacktracks,nbReusedTrail;
+    uint64_t nbCoreLearnts, nbTier2Learnts, nbLocalLearnts, nbPromotedTier, nbDemotedTier;
+    uint64_t nbVivifyRounds, nbVivified, nbVivifiedLits;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
     int action;
     double reward_multiplier;
@@ -260,11 +287,22 @@ protected:
 */
     };
 
+    // Watcher of a ternary clause: holds both other literals of the clause, so that propagation only
+    // looks at the clause when neither of them is true:
+    struct TernaryWatcher {
+        CRef cref;
+        Lit  other1, other2;
+        TernaryWatcher(CRef cr, Lit p, Lit q) : cref(cr), other1(p), other2(q) {}
+        bool operator==(const TernaryWatcher& w) const { return cref == w.cref; }
+        bool operator!=(const TernaryWatcher& w) const { return cref != w.cref; }
+    };
+
     struct WatcherDeleted
     {
         const ClauseAllocator& ca;
         WatcherDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
-        bool operator()(const Watcher& w) const { return ca[w.cref].mark() == 1; }
+        template<class W>
+        bool operator()(const W& w) const { return ca[w.cref].mark() == 1; }
     };
 
     struct VarOrderLt {
@@ -285,6 +323,8 @@ protected:
                         watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
     OccLists<Lit, vec<Watcher>, WatcherDeleted>
                         watchesBin;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    OccLists<Lit, vec<TernaryWatcher>, WatcherDeleted>
+                        watchesTer;       // Same as 'watches', for the ternary clauses.
     OccLists<Lit, vec<Watcher>, WatcherDeleted>
                         unaryWatches;       //  Unary watch scheme (clauses are seen when they become empty
     vec<CRef>           clauses;          // List of problem clauses.
@@ -316,6 +356,8 @@ protected:
     ClauseAllocator     ca;
 
     int nbclausesbeforereduce;            // To know when it is time to reduce clause database
+    uint64_t next_vivify;                 // Conflicts of the next vivification.
+    uint64_t vivify_props;                // Propagations at the end of the last vivification.
     
     // Used for restart strategies
     bqueue<unsigned int> trailQueue,lbdQueue; // Bounded queues for restarts.
@@ -331,8 +373,27 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<Lit>            trail_kept;       // Assignments below the target level that 'cancelUntil()' keeps.
+    vec<CRef>           reduce_local;     // Deletion candidates of the local tier in 'reduceDB()'.
+    vec<CRef>           vivify_cands;
+    vec<Lit>            vivify_lits;
     unsigned int  MYFLAG;
 
+    // Resolution trace:
+    //
+    struct TraceFrame { CRef cref; int next; };
+    struct CRefHash { uint32_t operator()(CRef cr) const { return cr; } };
+    uint64_t            nextClauseId;     // Input and derived clauses share the numbering.
+    Map<CRef,uint64_t,CRefHash> clauseIds; // ID of every clause in 'ca' (kept across garbage collections).
+    vec<uint64_t>       unitIds;          // ID of the unit clause of every top-level assignment.
+    int                 unitsTraced;      // Prefix of the top-level trail whose unit clauses are written.
+    vec<uint64_t>       traceHints;       // Antecedents of the next clause given to 'addClause_()' (empty for input clauses).
+    vec<uint64_t>       trace_chain;
+    vec<uint64_t>       trace_units;
+    vec<TraceFrame>     trace_stack;
+    vec<Var>            trace_toclear;
+    vec<Watcher>        trace_bin;        // Binary clauses 'minimisationWithBinaryResolution()' removed literals with.
+
     // Initial reduceDB strategy
     double              max_learnts;
     double              learntsize_adjust_confl;
@@ -358,17 +419,22 @@ protected:
     Lit      pickBranchLit    ();                                                      // Return the next decision variable.
     void     newDecisionLevel ();                                                      // Begins a new decision level.
     void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef);                         // Enqueue a literal. Assumes value of literal is undefined.
+    void     uncheckedEnqueue (Lit p, int level, CRef from);                           // Enqueue a literal at a level that may be below the current one.
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     CRef     propagate        ();                                                      // Perform unit propagation. Returns possibly conflicting clause.
     CRef     propagateUnaryWatches(Lit p);                                                  // Perform propagation on unary watches of p, can find only conflicts
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
+    int      conflictLevel    (CRef confl);                                            // Level of a conflict, or -1 after backtracking below a missed implication.
     void     analyze          (CRef confl, vec<Lit>& out_learnt, vec<Lit> & selectors, int& out_btlevel,unsigned int &nblevels,unsigned int &szWithoutSelectors);    // (bt = backtrack)
     void     analyzeFinal     (Lit p, vec<Lit>& out_conflict);                         // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p, uint32_t abstract_levels);                       // (helper method for 'analyze()')
     void     updateQ (Var v, double multiplier);
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
+    int      reuseTrail       (int level);                                             // Level a restart to 'level' can stop at without changing the next decisions.
     virtual lbool    solve_           (bool do_simp = true, bool turn_off_simp = false);                                                      // Main solve method (assumptions given in 'assumptions').
     virtual void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
+    bool     vivifyLearnts    ();                                                      // Shorten the core and tier-2 learnt clauses.
+    virtual bool     inprocess        ();                                                      // Simplify between restarts when it is time to.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
     void     rebuildOrderHeap ();
 
@@ -393,6 +459,16 @@ protected:
 
     virtual void     relocAll         (ClauseAllocator& to);
 
+    // Resolution trace:
+    //
+    uint64_t clauseId         (CRef cr);                                              // ID of a clause of 'ca'.
+    uint64_t unitId           (Var v);                                                // ID of the unit clause of a top-level assignment.
+    void     traceClause      (uint64_t id, const Lit* lits, int size, const vec<uint64_t>& hints);
+    void     traceUnits       ();                                                     // Writes the unit clauses of the top-level trail.
+    void     traceUnit        (Var v);                                                // Writes the unit clause of a top-level assignment above the first decision.
+    void     traceChain       (CRef confl, const Lit* c, int size, vec<uint64_t>& out); // Antecedents of 'c', derived from conflict 'confl'.
+    void     traceEmpty       (CRef confl);                                           // Writes the empty clause of a top-level conflict.
+
     // Misc:
     //
     int      decisionLevel    ()      const; // Gives the current decisionlevel.
@@ -565,6 +641,19 @@ struct reduceDB_lt {
     }
 };
 
+struct vivify_lt {
+    ClauseAllocator& ca;
+
+    vivify_lt(ClauseAllocator& ca_) : ca(ca_) {
+    }
+
+    // The best clauses first: lowest LBD, then highest activity
+    bool operator()(CRef x, CRef y) {
+        if (ca[x].lbd() != ca[y].lbd()) return ca[x].lbd() < ca[y].lbd();
+        return ca[x].activity() > ca[y].activity();
+    }
+};
+
 
 }
 
@@ -162,6 +162,9 @@ class Clause {
       unsigned szWithoutSelectors : BITS_SIZEWITHOUTSEL;
       unsigned canbedel   : 1;
       unsigned extra_size : 2; // extra size (end of 32bits) 0..3       
+      unsigned tier       : 2; // Learnt clause database tier (see 'Solver::reduceDB()')
+      unsigned used       : 1; // Learnt clause used in conflict analysis since the last reduction
+      unsigned vivified   : 1; // Learnt clause already vivified (see 'Solver::vivifyLearnts()')
       unsigned size       : BITS_REALSIZE;
       unsigned seen       : 1;
       unsigned reloced    : 1;
@@ -185,6 +188,9 @@ class Clause {
         header.size      = ps.size();
 	header.lbd = 0;
 	header.canbedel = 1;
+	header.tier = 0;
+	header.used = 0;
+	header.vivified = 0;
 	header.exported = 0; 
 	header.oneWatched = 0;
 	header.seen = 0;
@@ -251,6 +257,12 @@ public:
     unsigned int        lbd    () const        { return header.lbd; }
     void setCanBeDel(bool b) {header.canbedel = b;}
     bool canBeDel() {return header.canbedel;}
+    void setTier(unsigned int t) {header.tier = t;}
+    unsigned int tier() const {return header.tier;}
+    void setUsed(bool b) {header.used = b;}
+    bool used() const {return header.used;}
+    void setVivified(bool b) {header.vivified = b;}
+    bool vivified() const {return header.vivified;}
     void setSeen(bool b) {header.seen = b;}
     bool getSeen() {return header.seen;}
     void setExported(unsigned int b) {header.exported = b;}
@@ -329,6 +341,9 @@ class ClauseAllocator : public RegionAllocator<uint32_t>
 	  to[cr].setSeen(c.getSeen());
 	  to[cr].setSizeWithoutSelectors(c.sizeWithoutSelectors());
 	  to[cr].setCanBeDel(c.canBeDel());
+	  to[cr].setTier(c.tier());
+	  to[cr].setUsed(c.used());
+	  to[cr].setVivified(c.vivified());
 	  if (c.wasImported()) {
              to[cr].setImportedFrom(c.importedFrom());
 	  }
@@ -82,6 +82,36 @@ template <class T> static inline void sort(T* array, int size) {
     sort(array, size, LessThan_default<T>()); }
 
 
+// Moves the 'k' smallest elements to the front of 'array', in no particular order. Only the side
+// of each partition that holds the k-th element is partitioned again.
+template <class T, class LessThan>
+void select(T* array, int size, int k, LessThan lt)
+{
+    while (size > 15 && k > 0 && k < size){
+        T           pivot = array[size / 2];
+        T           tmp;
+        int         i = -1;
+        int         j = size;
+
+        for(;;){
+            do i++; while(lt(array[i], pivot));
+            do j--; while(lt(pivot, array[j]));
+
+            if (i >= j) break;
+
+            tmp = array[i]; array[i] = array[j]; array[j] = tmp;
+        }
+
+        if (k <= i)
+            size = i;
+        else
+            array += i, size -= i, k -= i;
+    }
+    if (k > 0 && k < size)
+        selectionSort(array, size, lt);
+}
+
+
 //=================================================================================================
 // For 'vec's:
 
@@ -90,6 +120,8 @@ template <class T, class LessThan> void sort(vec<T>& v, LessThan lt) {
     sort((T*)v, v.size(), lt); }
 template <class T> void sort(vec<T>& v) {
     sort(v, LessThan_default<T>()); }
+template <class T, class LessThan> void select(vec<T>& v, int k, LessThan lt) {
+    select((T*)v, v.size(), k, lt); }
 
 
 //=================================================================================================
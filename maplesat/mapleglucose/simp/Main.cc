@@ -64,6 +64,7 @@ using namespace Glucose;
 //=================================================================================================
 
 static const char* _certified = "CORE -- CERTIFIED UNSAT";
+static const char* _trace = "CORE -- RESOLUTION TRACE";
 
 void printStats(Solver& solver)
 {
@@ -71,12 +72,20 @@ void printStats(Solver& solver)
     double mem_used = 0;//memUsedPeak();
     printf("c restarts              : %" PRIu64" (%" PRIu64" conflicts in avg)\n", solver.starts,(solver.starts>0 ?solver.conflicts/solver.starts : 0));
     printf("c blocked restarts      : %" PRIu64" (multiple: %" PRIu64") \n", solver.nbstopsrestarts,solver.nbstopsrestartssame);
+    if (solver.reuse_trail)
+        printf("c reused trail          : %" PRIu64" (%" PRIu64" in avg)\n", solver.nbReusedTrail,(solver.starts>0 ?solver.nbReusedTrail/solver.starts : 0));
     printf("c last block at restart : %" PRIu64"\n",solver.lastblockatrestart);
     printf("c nb ReduceDB           : %" PRIu64"\n", solver.nbReduceDB);
     printf("c nb removed Clauses    : %" PRIu64"\n",solver.nbRemovedClauses);
     printf("c nb learnts DL2        : %" PRIu64"\n", solver.nbDL2);
     printf("c nb learnts size 2     : %" PRIu64"\n", solver.nbBin);
     printf("c nb learnts size 1     : %" PRIu64"\n", solver.nbUn);
+    printf("c learnt tiers          : %" PRIu64" core, %" PRIu64" tier2, %" PRIu64" local (at the last ReduceDB)\n", solver.nbCoreLearnts, solver.nbTier2Learnts, solver.nbLocalLearnts);
+    printf("c tier churn            : %" PRIu64" promoted, %" PRIu64" demoted\n", solver.nbPromotedTier, solver.nbDemotedTier);
+    if (solver.chrono >= 0)
+        printf("c chrono backtracks     : %" PRIu64"\n", solver.nbChronoBacktracks);
+    if (solver.vivify_confl > 0)
+        printf("c vivified learnts      : %" PRIu64" (%" PRIu64" literals removed, %" PRIu64" rounds)\n", solver.nbVivified, solver.nbVivifiedLits, solver.nbVivifyRounds);
 
     printf("c conflicts             : %-12" PRIu64"   (%.0f /sec)\n", solver.conflicts   , solver.conflicts   /cpu_time);
     printf("c decisions             : %-12" PRIu64"   (%4.2f %% random) (%.0f /sec)\n", solver.decisions, (float)solver.rnd_decisions*100 / (float)solver.decisions, solver.decisions   /cpu_time);
@@ -103,6 +112,11 @@ static void SIGINT_exit(int signum) {
     if (solver->verbosity > 0){
         printStats(*solver);
         printf("\n"); printf("*** INTERRUPTED ***\n"); }
+#ifdef PROFILE_COUNTERS
+    solver->writeProfile(); // (the totals of a run stopped by a time limit)
+    fflush(solver->profileOutput);
+    fflush(stdout);
+#endif
     _exit(1); }
 
 
@@ -136,6 +150,11 @@ int main(int argc, char** argv)
 
          BoolOption    opt_certified      (_certified, "certified",    "Certified UNSAT using DRUP format", false);
          StringOption  opt_certified_file      (_certified, "certified-output",    "Certified UNSAT output file", "NULL");
+         BoolOption    opt_trace          (_trace, "trace",        "Resolution trace with clause IDs in TraceCheck format", false);
+         StringOption  opt_trace_file          (_trace, "trace-output",        "Resolution trace output file", "NULL");
+#ifdef PROFILE_COUNTERS
+         StringOption  opt_profile_file        ("PROFILE", "profile-output",   "JSON output file of the profile counters", "NULL");
+#endif
          
         parseOptions(argc, argv, true);
         
@@ -159,11 +178,33 @@ int main(int argc, char** argv)
             fprintf(S.certifiedOutput,"o proof DRUP\n");
         }
 
+        S.traceProof = opt_trace;
+        if(S.traceProof) {
+            if(!strcmp(opt_trace_file,"NULL")) {
+            S.traceOutput =  fopen("/dev/stdout", "wb");
+            } else {
+                S.traceOutput =  fopen(opt_trace_file, "wb");
+            }
+        }
+
+#ifdef PROFILE_COUNTERS
+        if(!strcmp(opt_profile_file,"NULL")) {
+            S.profileOutput =  stdout; // (as comment lines of the solver output)
+        } else {
+            S.profileOutput =  fopen(opt_profile_file, "wb");
+            if (S.profileOutput == NULL)
+                printf("ERROR! Could not open file: %s\n", (const char*)opt_profile_file), exit(1);
+        }
+#endif
+
         solver = &S;
         // Use signal handlers that forcibly quit until the solver will be able to respond to
         // interrupts:
         signal(SIGINT, SIGINT_exit);
         signal(SIGXCPU,SIGINT_exit);
+#ifdef PROFILE_COUNTERS
+        signal(SIGTERM,SIGINT_exit);
+#endif
 
 
         // Set limit on CPU-time:
@@ -215,6 +256,9 @@ int main(int argc, char** argv)
         // voluntarily:
         signal(SIGINT, SIGINT_interrupt);
         signal(SIGXCPU,SIGINT_interrupt);
+#ifdef PROFILE_COUNTERS
+        signal(SIGTERM,SIGINT_interrupt);
+#endif
 
         S.parsing = 0;
         if(pre/* && !S.isIncremental()*/) {
@@ -228,12 +272,16 @@ int main(int argc, char** argv)
 	printf("c |                                                                                                       |\n");
         if (!S.okay()){
             if (S.certifiedUNSAT) fprintf(S.certifiedOutput, "0\n"), fclose(S.certifiedOutput);
+            if (S.traceProof) fclose(S.traceOutput);
             if (res != NULL) fprintf(res, "UNSAT\n"), fclose(res);
             if (S.verbosity > 0){
  	        printf("c =========================================================================================================\n");
                printf("Solved by simplification\n");
                 printStats(S);
                 printf("\n"); }
+#ifdef PROFILE_COUNTERS
+            S.writeProfile();
+#endif
             printf("s UNSATISFIABLE\n");        
             exit(20);
         }
@@ -252,7 +300,15 @@ int main(int argc, char** argv)
         
         if (S.verbosity > 0){
             printStats(S);
+            if (S.inprocess_confl > 0)
+                printf("c inprocessing          : %d rounds (%d vars eliminated)\n", S.inprocess_rounds, S.inprocess_elim);
+            if (S.use_equiv)
+                printf("c substituted vars      : %d\n", S.substituted_vars);
             printf("\n"); }
+#ifdef PROFILE_COUNTERS
+        S.writeProfile();
+        if (S.profileOutput != stdout) fclose(S.profileOutput);
+#endif
         printf(ret == l_True ? "s SATISFIABLE\n" : ret == l_False ? "s UNSATISFIABLE\n" : "s INDETERMINATE\n");
 
         if (res != NULL){
@@ -279,7 +335,7 @@ int main(int argc, char** argv)
 
 	}
 
-        if (S.certifiedUNSAT) fprintf(S.certifiedOutput, "0\n"), fclose(S.certifiedOutput);
+        if (S.traceProof) fclose(S.traceOutput); // ('solve_()' closes the DRUP proof)
 
 #ifdef NDEBUG
         exit(ret == l_True ? 10 : ret == l_False ? 20 : 0);     // (faster than "return", which will invoke the destructor for 'Solver')
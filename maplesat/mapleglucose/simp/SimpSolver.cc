@@ -62,10 +62,14 @@ static const char* _cat = "SIMP";
 static BoolOption   opt_use_asymm        (_cat, "asymm",        "Shrink clauses by asymmetric branching.", false);
 static BoolOption   opt_use_rcheck       (_cat, "rcheck",       "Check if a clause is already implied. (costly)", false);
 static BoolOption   opt_use_elim         (_cat, "elim",         "Perform variable elimination.", true);
+static BoolOption   opt_use_equiv        (_cat, "equiv",        "Substitute the equivalent literals of the binary implication graph.", true);
 static IntOption    opt_grow             (_cat, "grow",         "Allow a variable elimination step to grow by a number of clauses.", 0);
 static IntOption    opt_clause_lim       (_cat, "cl-lim",       "Variables are not eliminated if it produces a resolvent with a length above this limit. -1 means no limit", 20,   IntRange(-1, INT32_MAX));
 static IntOption    opt_subsumption_lim  (_cat, "sub-lim",      "Do not check if subsumption against a clause larger than this. -1 means no limit.", 1000, IntRange(-1, INT32_MAX));
 static DoubleOption opt_simp_garbage_frac(_cat, "simp-gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered during simplification.",  0.5, DoubleRange(0, false, HUGE_VAL, false));
+static IntOption    opt_inprocess_confl  (_cat, "inprocess-confl", "The number of conflicts between two inprocessing rounds of elimination and subsumption (0=never).", 0, IntRange(0, INT32_MAX));
+static DoubleOption opt_inprocess_time   (_cat, "inprocess-time",  "The CPU time of an inprocessing round, relative to the time of the search since the last one.", 0.1, DoubleRange(0, false, HUGE_VAL, false));
+static BoolOption   opt_inprocess_asymm  (_cat, "inprocess-asymm", "Shrink clauses by asymmetric branching in the inprocessing rounds.", true);
 
 
 //=================================================================================================
@@ -81,15 +85,25 @@ SimpSolver::SimpSolver() :
   , use_asymm          (opt_use_asymm)
   , use_rcheck         (opt_use_rcheck)
   , use_elim           (opt_use_elim)
+  , use_equiv          (opt_use_equiv)
+  , inprocess_confl    (opt_inprocess_confl)
+  , inprocess_time     (opt_inprocess_time)
+  , inprocess_asymm    (opt_inprocess_asymm)
   , merges             (0)
   , asymm_lits         (0)
   , eliminated_vars    (0)
+  , inprocess_rounds   (0)
+  , inprocess_elim     (0)
+  , substituted_vars   (0)
   , elimorder          (1)
   , use_simplification (true)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (0)
   , n_touched          (0)
+  , next_inprocess     (opt_inprocess_confl)
+  , inprocess_end      (0)
+  , simp_deadline      (0)
 {
     vec<Lit> dummy(1,lit_Undef);
     ca.extra_clause_field = true; // NOTE: must happen before allocating the dummy clause below.
@@ -112,15 +126,25 @@ SimpSolver::SimpSolver(const SimpSolver &s) : Solver(s)
   , use_asymm          (s.use_asymm)
   , use_rcheck         (s.use_rcheck)
   , use_elim           (s.use_elim)
+  , use_equiv          (s.use_equiv)
+  , inprocess_confl    (s.inprocess_confl)
+  , inprocess_time     (s.inprocess_time)
+  , inprocess_asymm    (s.inprocess_asymm)
   , merges             (s.merges)
   , asymm_lits         (s.asymm_lits)
   , eliminated_vars    (s.eliminated_vars)
+  , inprocess_rounds   (s.inprocess_rounds)
+  , inprocess_elim     (s.inprocess_elim)
+  , substituted_vars   (s.substituted_vars)
   , elimorder          (s.elimorder)
   , use_simplification (s.use_simplification)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (s.bwdsub_assigns)
   , n_touched          (s.n_touched)
+  , next_inprocess     (s.next_inprocess)
+  , inprocess_end      (s.inprocess_end)
+  , simp_deadline      (0)
 {
     // TODO: Copy dummy... what is it???
     vec<Lit> dummy(1,lit_Undef);
@@ -213,8 +237,11 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
 #endif
     int nclauses = clauses.size();
 
-    if (use_rcheck && implied(ps))
-        return true;
+    if (use_rcheck && implied(ps)){
+        if (traceProof && traceHints.size() == 0)
+            traceClause(++nextClauseId, ps, ps.size(), traceHints); // (input clauses keep their IDs)
+        traceHints.clear();
+        return true; }
 
     if (!Solver::addClause_(ps))
         return false;
@@ -276,6 +303,9 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
     // if (!find(subsumption_queue, &c))
     subsumption_queue.insert(cr);
 
+    if (traceProof)
+        traceUnits(); // (before a reason loses a literal)
+
     if (certifiedUNSAT) {
       for (int i = 0; i < c.size(); i++)
         if (c[i] != l) fprintf(certifiedOutput, "%i " , (var(c[i]) + 1) * (-2 * sign(c[i]) + 1) );
@@ -285,6 +315,19 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
     if (c.size() == 2){
         removeClause(cr);
         c.strengthen(l);
+        if (traceProof){
+            // The antecedents are in 'traceHints':
+            uint64_t id = ++nextClauseId;
+            traceClause(id, c, c.size(), traceHints);
+            traceHints.clear();
+            if (value(c[0]) == l_False){
+                trace_chain.clear();
+                trace_chain.push(unitId(var(c[0])));
+                trace_chain.push(id);
+                traceClause(++nextClauseId, NULL, 0, trace_chain);
+            }else if (value(c[0]) == l_Undef)
+                unitIds[var(c[0])] = id;
+        }
     }else{
         if (certifiedUNSAT) {
           fprintf(certifiedOutput, "d ");
@@ -296,12 +339,22 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
         detachClause(cr, true);
         c.strengthen(l);
         attachClause(cr);
+        if (traceProof){
+            clauseIds[cr] = ++nextClauseId;
+            traceClause(clauseIds[cr], c, c.size(), traceHints);
+            traceHints.clear();
+        }
         remove(occurs[var(l)], cr);
         n_occ[toInt(l)]--;
         updateElimHeap(var(l));
     }
 
-    return c.size() == 1 ? enqueue(c[0]) && propagate() == CRef_Undef : true;
+    if (c.size() > 1 || !enqueue(c[0]))
+        return c.size() > 1;
+    CRef confl = propagate();
+    if (confl != CRef_Undef && traceProof)
+        traceEmpty(confl);
+    return confl == CRef_Undef;
 }
 
 
@@ -430,6 +483,10 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
             bwdsub_assigns = trail.size();
             break; }
 
+        // Leave the rest of the queue to the next inprocessing round when out of time:
+        if (simp_deadline > 0 && ++cnt % 1000 == 0 && !withinSimpBudget())
+            break;
+
         // Check top-level assignments by creating a dummy clause and placing it in the queue:
         if (subsumption_queue.size() == 0 && bwdsub_assigns < trail.size()){
             Lit l = trail[bwdsub_assigns++];
@@ -468,6 +525,11 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
                 else if (l != lit_Error){
                     deleted_literals++;
 
+                    if (traceProof){
+                        traceHints.push(cr == bwdsub_tmpunit ? unitId(var(c[0])) : clauseId(cr));
+                        traceHints.push(clauseId(cs[j]));
+                    }
+
                     if (!strengthenClause(cs[j], ~l))
                         return false;
 
@@ -497,7 +559,16 @@ bool SimpSolver::asymm(Var v, CRef cr)
         else
             l = c[i];
 
-    if (propagate() != CRef_Undef){
+    CRef confl = propagate();
+    if (confl != CRef_Undef){
+        if (traceProof){
+            // The leaves are the literals of the strengthened clause ('l' itself may have been propagated):
+            vec<Lit>& rest = add_tmp;
+            rest.clear();
+            for (int i = 0; i < c.size(); i++)
+                if (c[i] != l) rest.push(c[i]);
+            traceChain(confl, rest, rest.size(), traceHints);
+        }
         cancelUntil(0);
         asymm_lits++;
         if (!strengthenClause(cr, l))
@@ -604,8 +675,14 @@ bool SimpSolver::eliminateVar(Var v)
     vec<Lit>& resolvent = add_tmp;
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, resolvent) && !addClause_(resolvent))
-                return false;
+            if (merge(ca[pos[i]], ca[neg[j]], v, resolvent)){
+                if (traceProof){
+                    traceHints.push(clauseId(pos[i]));
+                    traceHints.push(clauseId(neg[j]));
+                }
+                if (!addClause_(resolvent))
+                    return false;
+            }
 
     for (int i = 0; i < cls.size(); i++)
         removeClause(cls[i]);
@@ -621,7 +698,7 @@ bool SimpSolver::eliminateVar(Var v)
 }
 
 
-bool SimpSolver::substitute(Var v, Lit x)
+bool SimpSolver::substitute(Var v, Lit x, uint64_t v_to_x, uint64_t x_to_v)
 {
     assert(!frozen[v]);
     assert(!isEliminated(v));
@@ -631,6 +708,16 @@ bool SimpSolver::substitute(Var v, Lit x)
 
     eliminated[v] = true;
     setDecisionVar(v, false);
+    substituted_vars++;
+
+    // The model of 'v' is the one of 'x':
+    elimclauses.push(toInt(mkLit(v)));
+    elimclauses.push(toInt(~x));
+    elimclauses.push(2);
+    elimclauses.push(toInt(~mkLit(v)));
+    elimclauses.push(toInt(x));
+    elimclauses.push(2);
+
     const vec<CRef>& cls = occurs.lookup(v);
     
     vec<Lit>& subst_clause = add_tmp;
@@ -638,11 +725,17 @@ bool SimpSolver::substitute(Var v, Lit x)
         Clause& c = ca[cls[i]];
 
         subst_clause.clear();
+        bool positive = false;
         for (int j = 0; j < c.size(); j++){
             Lit p = c[j];
             subst_clause.push(var(p) == v ? x ^ sign(p) : p);
+            if (p == mkLit(v)) positive = true;
         }
 
+        if (traceProof){
+            traceHints.push(positive ? v_to_x : x_to_v);
+            traceHints.push(clauseId(cls[i]));
+        }
  
         if (!addClause_(subst_clause))
             return ok = false;
@@ -651,10 +744,179 @@ bool SimpSolver::substitute(Var v, Lit x)
  
    }
 
+    occurs[v].clear(true);
     return true;
 }
 
 
+// Spans the strongly connected component 'comp[toInt(root)]' of the binary implication graph from
+// 'root': 'parent[toInt(l)]' is the binary clause through which 'l' is first reached.
+void SimpSolver::spanEquivalents(Lit root, const vec<int>& comp, vec<CRef>& parent)
+{
+    vec<Lit> queue;
+    queue.push(root);
+    for (int i = 0; i < queue.size(); i++){
+        Lit p = queue[i];
+        const vec<Watcher>& ws = watchesBin[p];
+        for (int k = 0; k < ws.size(); k++){
+            Lit q = ws[k].blocker;
+            if (comp[toInt(q)] == comp[toInt(root)] && q != root && parent[toInt(q)] == CRef_Undef){
+                parent[toInt(q)] = ws[k].cref;
+                queue.push(q);
+            }
+        }
+    }
+}
+
+
+// The clause IDs of the implication chain from 'root' to 'l' (as spanned by 'spanEquivalents()').
+void SimpSolver::equivalencePath(Lit root, Lit l, const vec<CRef>& parent, vec<uint64_t>& out)
+{
+    out.clear();
+    while (l != root){
+        const Clause& c = ca[parent[toInt(l)]];
+        out.push(clauseId(parent[toInt(l)]));
+        l = c[0] == l ? ~c[1] : ~c[0];
+    }
+    for (int i = 0, j = out.size() - 1; i < j; i++, j--){
+        uint64_t tmp = out[i]; out[i] = out[j]; out[j] = tmp; }
+}
+
+
+// Finds the strongly connected components of the binary implication graph (Tarjan) and replaces
+// every variable of a component by the representative of the component, i.e. its frozen literal
+// (if any) of the smallest variable. The equivalences are written to the proofs first, since the
+// binary clauses they are derived from disappear with the substitution.
+bool SimpSolver::substituteEquivalents()
+{
+    assert(decisionLevel() == 0);
+
+    int      n = 2 * nVars();
+    vec<int> index(n, -1), low(n, 0), comp(n, -1);
+    vec<Lit> stack, path;
+    vec<int> next;                  // Position in the watcher list of every literal of 'path'.
+    vec<Lit> repr(n, lit_Undef);
+    int      counter = 0, ncomps = 0;
+    bool     found   = false;
+
+    watchesBin.cleanAll();
+    for (int r = 0; r < n; r++){
+        Lit root = toLit(r);
+        if (index[r] != -1 || value(root) != l_Undef || isEliminated(var(root))) continue;
+
+        index[r] = low[r] = counter++;
+        stack.push(root);
+        path.push(root);
+        next.push(0);
+        while (path.size() > 0){
+            Lit                 p  = path.last();
+            const vec<Watcher>& ws = watchesBin[p];
+            if (next.last() < ws.size()){
+                Lit q = ws[next.last()++].blocker;
+                if (value(q) != l_Undef || isEliminated(var(q))) continue;
+                if (index[toInt(q)] == -1){
+                    index[toInt(q)] = low[toInt(q)] = counter++;
+                    stack.push(q);
+                    path.push(q);
+                    next.push(0);
+                }else if (comp[toInt(q)] == -1 && index[toInt(q)] < low[toInt(p)])
+                    low[toInt(p)] = index[toInt(q)];
+                continue;
+            }
+
+            path.pop();
+            next.pop();
+            if (path.size() > 0 && low[toInt(p)] < low[toInt(path.last())])
+                low[toInt(path.last())] = low[toInt(p)];
+            if (low[toInt(p)] != index[toInt(p)]) continue;
+
+            // 'p' is the root of a component: choose its representative.
+            int  first = stack.size() - 1;
+            while (stack[first] != p) first--;
+            Lit  rep   = p;
+            for (int i = first; i < stack.size(); i++){
+                Lit q = stack[i];
+                comp[toInt(q)] = ncomps;
+                if (frozen[var(q)] > frozen[var(rep)] || (frozen[var(q)] == frozen[var(rep)] && toInt(q) < toInt(rep)))
+                    rep = q;
+            }
+            for (int i = first; i < stack.size(); i++)
+                repr[toInt(stack[i])] = rep;
+            if (stack.size() - first > 1) found = true;
+            stack.shrink(stack.size() - first);
+            ncomps++;
+        }
+    }
+
+    if (!found) return true;
+
+    // Write the equivalences 'l <-> repr(l)' to the proofs, and substitute the variables:
+    vec<CRef>     parent(n, CRef_Undef);
+    vec<uint64_t> hints;
+    vec<Var>      subst;
+    vec<uint64_t> ids;
+    for (int r = 0; r < n; r++){
+        Lit root = toLit(r);
+        if (repr[r] != root || sign(root)) continue;
+
+        spanEquivalents(root, comp, parent);
+        if (comp[toInt(~root)] == comp[r]){
+            // 'root' implies '~root' and the other way around:
+            equivalencePath(root, ~root, parent, hints);
+            if (certifiedUNSAT)
+                fprintf(certifiedOutput, "%i 0\n", (var(root) + 1) * (-2 * sign(~root) + 1));
+            if (traceProof)
+                hints.moveTo(traceHints);
+            vec<Lit> unit;
+            unit.push(~root);
+            return Solver::addClause_(unit);
+        }
+        spanEquivalents(~root, comp, parent);
+    }
+
+    for (Var v = 0; v < nVars(); v++){
+        Lit m = mkLit(v), x = repr[toInt(m)];
+        if (x == lit_Undef || var(x) == v || frozen[v]) continue;
+
+        // '~m | x' follows from the chain '~x -> ~m', and 'm | ~x' from 'x -> m':
+        uint64_t id_pos = 0, id_neg = 0;
+        if (traceProof){
+            Lit bin[2];
+            equivalencePath(~x, ~m, parent, hints);
+            bin[0] = ~m; bin[1] = x;
+            traceClause(id_pos = ++nextClauseId, bin, 2, hints);
+            equivalencePath(x, m, parent, hints);
+            bin[0] = m; bin[1] = ~x;
+            traceClause(id_neg = ++nextClauseId, bin, 2, hints);
+        }
+        if (certifiedUNSAT){
+            fprintf(certifiedOutput, "%i %i 0\n", -(v + 1), (var(x) + 1) * (-2 * sign(x) + 1));
+            fprintf(certifiedOutput, "%i %i 0\n",  (v + 1), (var(x) + 1) * (-2 * sign(~x) + 1));
+        }
+        subst.push(v);
+        ids.push(id_pos);
+        ids.push(id_neg);
+    }
+
+    for (int i = 0; i < subst.size() && ok; i++){
+        Var v = subst[i];
+        Lit x = repr[toInt(mkLit(v))];
+        if (value(v) == l_Undef && !substitute(v, x, ids[2*i], ids[2*i+1]))
+            return false;
+    }
+
+    if (certifiedUNSAT)
+        for (int i = 0; i < subst.size(); i++){
+            Var v = subst[i];
+            Lit x = repr[toInt(mkLit(v))];
+            fprintf(certifiedOutput, "d %i %i 0\n", -(v + 1), (var(x) + 1) * (-2 * sign(x) + 1));
+            fprintf(certifiedOutput, "d %i %i 0\n",  (v + 1), (var(x) + 1) * (-2 * sign(~x) + 1));
+        }
+
+    return ok;
+}
+
+
 void SimpSolver::extendModel()
 {
     int i, j;
@@ -692,7 +954,10 @@ bool SimpSolver::eliminate(bool turn_off_elim)
       printf("c Too many clauses... No preprocessing\n");
     }
 
-    while (toPerform && (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0)){
+    if (toPerform && use_equiv && !substituteEquivalents()){
+        ok = false; goto cleanup; }
+
+    while (toPerform && (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0) && withinSimpBudget()){
 
         gatherTouchedClauses();
         // printf("  ## (time = %6.2f s) BWD-SUB: queue = %d, trail = %d\n", cpuTime(), subsumption_queue.size(), trail.size() - bwdsub_assigns);
@@ -710,9 +975,9 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 
         // printf("  ## (time = %6.2f s) ELIM: vars = %d\n", cpuTime(), elim_heap.size());
         for (int cnt = 0; !elim_heap.empty(); cnt++){
+            if (asynch_interrupt || !withinSimpBudget()) break;
+
             Var elim = elim_heap.removeMin();
-            
-            if (asynch_interrupt) break;
 
             if (isEliminated(elim) || value(elim) != l_Undef) continue;
 
@@ -735,21 +1000,24 @@ bool SimpSolver::eliminate(bool turn_off_elim)
             checkGarbage(simp_garbage_frac);
         }
 
-        assert(subsumption_queue.size() == 0);
+        assert(subsumption_queue.size() == 0 || !withinSimpBudget());
     }
  cleanup:
 
-    // If no more simplification is needed, free all simplification-related data structures:
     if (turn_off_elim){
-        touched  .clear(true);
-        occurs   .clear(true);
-        n_occ    .clear(true);
-        elim_heap.clear(true);
-        subsumption_queue.clear(true);
-
-        use_simplification    = false;
-        remove_satisfied      = true;
-        ca.extra_clause_field = false;
+        // If no more simplification is needed, free all simplification-related data structures (the
+        // inprocessing rounds keep them up to date during the search instead):
+        if (inprocess_confl == 0){
+            touched  .clear(true);
+            occurs   .clear(true);
+            n_occ    .clear(true);
+            elim_heap.clear(true);
+            subsumption_queue.clear(true);
+
+            use_simplification    = false;
+            remove_satisfied      = true;
+            ca.extra_clause_field = false;
+        }
 
         // Force full cleanup (this is safe and desirable since it only happens once):
         rebuildOrderHeap();
@@ -760,7 +1028,7 @@ bool SimpSolver::eliminate(bool turn_off_elim)
         checkGarbage();
     }
 
-    if (verbosity >= 0 && elimclauses.size() > 0)
+    if (verbosity >= 0 && elimclauses.size() > 0 && simp_deadline == 0)
         printf("c |  Eliminated clauses:     %10.2f Mb                                                                |\n", 
                double(elimclauses.size() * sizeof(uint32_t)) / (1024*1024));
 
@@ -771,6 +1039,67 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 }
 
 
+bool SimpSolver::withinSimpBudget() const
+{
+    return simp_deadline == 0 || cpuTime() < simp_deadline;
+}
+
+
+// Re-runs elimination, subsumption and asymmetric branching on the problem clauses every
+// 'inprocess_confl' conflicts. The occurrence lists are kept alive during the search, so a round only
+// revisits the variables and clauses touched since the last one (e.g. by new top-level units), and it
+// stops when its share 'inprocess_time' of the CPU time is used up, leaving the rest to the next one.
+bool SimpSolver::inprocess()
+{
+    if (!Solver::inprocess())
+        return false;
+    if (!use_simplification || inprocess_confl == 0 || conflicts < next_inprocess)
+        return true;
+
+    cancelUntil(0);
+    next_inprocess = conflicts + inprocess_confl;
+    inprocess_rounds++;
+
+    double now      = cpuTime();
+    simp_deadline   = now + (now - inprocess_end) * inprocess_time;
+    int  elim_before   = eliminated_vars + substituted_vars;
+    bool was_asymm     = use_asymm;
+    use_asymm          = use_asymm || inprocess_asymm;
+
+    eliminate(false);
+
+    use_asymm       = was_asymm;
+    simp_deadline   = 0;
+    inprocess_end   = cpuTime();
+
+    if (ok && eliminated_vars + substituted_vars > elim_before){
+        inprocess_elim += eliminated_vars + substituted_vars - elim_before;
+        removeEliminatedLearnts();
+    }
+
+    return ok;
+}
+
+
+// Learnt clauses over eliminated (or substituted) variables are still implied by the problem, but they are useless to
+// the search and would only keep the variables assigned.
+void SimpSolver::removeEliminatedLearnts()
+{
+    int i, j;
+    for (i = j = 0; i < learnts.size(); i++){
+        const Clause& c = ca[learnts[i]];
+        int k = 0;
+        while (k < c.size() && !isEliminated(var(c[k]))) k++;
+        if (k < c.size())
+            Solver::removeClause(learnts[i]);
+        else
+            learnts[j++] = learnts[i];
+    }
+    learnts.shrink(i - j);
+    checkGarbage();
+}
+
+
 void SimpSolver::cleanUpClauses()
 {
     occurs.cleanAll();
@@ -811,12 +1140,14 @@ void SimpSolver::relocAll(ClauseAllocator& to)
 
 void SimpSolver::garbageCollect()
 {
+    PROFILE_PHASE(PROF_GC);
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted()); 
 
     cleanUpClauses();
     to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
+    if (traceProof) traceUnits(); // (before the reasons of top-level assignments are moved)
     relocAll(to);
     Solver::relocAll(to);
     if (verbosity >= 2)
@@ -86,7 +86,9 @@ class SimpSolver : public Solver {
     bool    addClause (Lit p, Lit q);        // Add a binary clause to the solver.
     bool    addClause (Lit p, Lit q, Lit r); // Add a ternary clause to the solver.
     virtual bool    addClause_(      vec<Lit>& ps);
-    bool    substitute(Var v, Lit x);  // Replace all occurences of v with x (may cause a contradiction).
+    bool    substitute(Var v, Lit x, uint64_t v_to_x = 0, uint64_t x_to_v = 0);
+                                       // Replace all occurences of v with x (may cause a contradiction). The IDs
+                                       // are those of '~v | x' and 'v | ~x' in the resolution trace.
 
     // Variable mode:
     // 
@@ -130,11 +132,18 @@ class SimpSolver : public Solver {
     bool    use_asymm;         // Shrink clauses by asymmetric branching.
     bool    use_rcheck;        // Check if a clause is already implied. Prett costly, and subsumes subsumptions :)
     bool    use_elim;          // Perform variable elimination.
+    bool    use_equiv;         // Substitute the equivalent literals of the binary implication graph.
+    int     inprocess_confl;   // Conflicts between two inprocessing rounds of elimination and subsumption (0=never).
+    double  inprocess_time;    // CPU time of a round, relative to the time of the search since the last one.
+    bool    inprocess_asymm;   // Shrink clauses by asymmetric branching in the inprocessing rounds.
     // Statistics:
     //
     int     merges;
     int     asymm_lits;
     int     eliminated_vars;
+    int     inprocess_rounds;
+    int     inprocess_elim;    // Variables eliminated or substituted by the inprocessing rounds.
+    int     substituted_vars;  // Variables replaced by an equivalent literal.
 
  protected:
 
@@ -176,6 +185,9 @@ class SimpSolver : public Solver {
     vec<char>           eliminated;
     int                 bwdsub_assigns;
     int                 n_touched;
+    uint64_t            next_inprocess;   // Conflicts of the next inprocessing round.
+    double              inprocess_end;    // CPU time at the end of the last inprocessing round.
+    double              simp_deadline;    // CPU time the current inprocessing round must stop at (0 outside of rounds).
 
     // Temporaries:
     //
@@ -184,6 +196,9 @@ class SimpSolver : public Solver {
     // Main internal methods:
     //
     virtual lbool         solve_                   (bool do_simp = true, bool turn_off_simp = false);
+    virtual bool          inprocess                ();
+    bool          withinSimpBudget         () const;
+    void          removeEliminatedLearnts  ();
     bool          asymm                    (Var v, CRef cr);
     bool          asymmVar                 (Var v);
     void          updateElimHeap           (Var v);
@@ -192,6 +207,9 @@ class SimpSolver : public Solver {
     bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, int& size);
     bool          backwardSubsumptionCheck (bool verbose = false);
     bool          eliminateVar             (Var v);
+    bool          substituteEquivalents    ();
+    void          spanEquivalents          (Lit root, const vec<int>& comp, vec<CRef>& parent);
+    void          equivalencePath          (Lit root, Lit l, const vec<CRef>& parent, vec<uint64_t>& out);
     void          extendModel              ();
 
     void          removeClause             (CRef cr,bool inPurgatory=false);
@@ -31,29 +31,28 @@ using namespace Minisat;
 
 static const char* _cat = "CORE";
 
-#if BRANCHING_HEURISTIC == CHB || BRANCHING_HEURISTIC == LRB
-static DoubleOption  opt_step_size         (_cat, "step-size",   "Initial step size",                             0.40,     DoubleRange(0, false, 1, false));
-static DoubleOption  opt_step_size_dec     (_cat, "step-size-dec","Step size decrement",                          0.000001, DoubleRange(0, false, 1, false));
-static DoubleOption  opt_min_step_size     (_cat, "min-step-size","Minimal step size",                            0.06,     DoubleRange(0, false, 1, false));
-#endif
-#if BRANCHING_HEURISTIC == VSIDS
-static DoubleOption  opt_var_decay         (_cat, "var-decay",   "The variable activity decay factor",            0.95,     DoubleRange(0, false, 1, false));
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
+static IntOption     opt_branching         (_cat, "branching",   "Branching heuristic (0=VSIDS, 1=CHB, 2=LRB)", 2, IntRange(0, 2));
+static BoolOption    opt_lbd_deletion      (_cat, "lbd-deletion", "Rank learnt clauses by LBD instead of activity", true);
+static BoolOption    opt_rapid_deletion    (_cat, "rapid-deletion", "Raise the learnt clause limit by a constant instead of geometrically", true);
+static BoolOption    opt_almost_conflict   (_cat, "almost-conflict", "Reward the variables of the reasons of learnt clauses (LRB only)", true);
+static BoolOption    opt_anti_exploration  (_cat, "anti-exploration", "Decay the activity of unassigned variables (LRB only)", true);
+static DoubleOption  opt_step_size         (_cat, "step-size",   "Initial step size (CHB, LRB)",                  0.40,     DoubleRange(0, false, 1, false));
+static DoubleOption  opt_step_size_dec     (_cat, "step-size-dec","Step size decrement (CHB, LRB)",               0.000001, DoubleRange(0, false, 1, false));
+static DoubleOption  opt_min_step_size     (_cat, "min-step-size","Minimal step size (CHB, LRB)",                 0.06,     DoubleRange(0, false, 1, false));
+static DoubleOption  opt_var_decay         (_cat, "var-decay",   "The variable activity decay factor (VSIDS)",    0.95,     DoubleRange(0, false, 1, false));
 static DoubleOption  opt_clause_decay      (_cat, "cla-decay",   "The clause activity decay factor",              0.999,    DoubleRange(0, false, 1, false));
-#endif
 static DoubleOption  opt_random_var_freq   (_cat, "rnd-freq",    "The frequency with which the decision heuristic tries to choose a random variable", 0, DoubleRange(0, true, 1, true));
 static DoubleOption  opt_random_seed       (_cat, "rnd-seed",    "Used by the random variable selection",         91648253, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption     opt_ccmin_mode        (_cat, "ccmin-mode",  "Controls conflict clause minimization (0=none, 1=basic, 2=deep)", 2, IntRange(0, 2));
 static IntOption     opt_phase_saving      (_cat, "phase-saving", "Controls the level of phase saving (0=none, 1=limited, 2=full)", 2, IntRange(0, 2));
+static IntOption     opt_chrono            (_cat, "chrono",      "Backtrack chronologically when a backjump would undo more levels than this (-1=never)", -1, IntRange(-1, INT32_MAX));
+static IntOption     opt_confl_to_chrono   (_cat, "confl-to-chrono", "The number of conflicts before backtracking chronologically", 4000, IntRange(0, INT32_MAX));
 static BoolOption    opt_rnd_init_act      (_cat, "rnd-init",    "Randomize the initial activity", false);
 static BoolOption    opt_luby_restart      (_cat, "luby",        "Use the Luby restart sequence", true);
 static IntOption     opt_restart_first     (_cat, "rfirst",      "The base restart interval", 100, IntRange(1, INT32_MAX));
 static DoubleOption  opt_restart_inc       (_cat, "rinc",        "Restart interval increase factor", 2, DoubleRange(1, false, HUGE_VAL, false));
 static DoubleOption  opt_garbage_frac      (_cat, "gc-frac",     "The fraction of wasted memory allowed before a garbage collection is triggered",  0.20, DoubleRange(0, false, HUGE_VAL, false));
-#if BRANCHING_HEURISTIC == CHB
-static DoubleOption  opt_reward_multiplier (_cat, "reward-multiplier", "Reward multiplier", 0.9, DoubleRange(0, true, 1, true));
-#endif
+static DoubleOption  opt_reward_multiplier (_cat, "reward-multiplier", "Reward multiplier (CHB)", 0.9, DoubleRange(0, true, 1, true));
 
 
 //=================================================================================================
@@ -65,22 +64,23 @@ Solver::Solver() :
     // Parameters (user settable):
     //
     verbosity        (0)
-#if BRANCHING_HEURISTIC == CHB || BRANCHING_HEURISTIC == LRB
+  , branching        (opt_branching)
+  , lbd_deletion     (opt_lbd_deletion)
+  , rapid_deletion   (opt_rapid_deletion)
+  , almost_conflict  (opt_almost_conflict)
+  , anti_exploration (opt_anti_exploration)
   , step_size        (opt_step_size)
   , step_size_dec    (opt_step_size_dec)
   , min_step_size    (opt_min_step_size)
-#endif
-#if BRANCHING_HEURISTIC == VSIDS
   , var_decay        (opt_var_decay)
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
   , clause_decay     (opt_clause_decay)
-#endif
   , random_var_freq  (opt_random_var_freq)
   , random_seed      (opt_random_seed)
   , luby_restart     (opt_luby_restart)
   , ccmin_mode       (opt_ccmin_mode)
   , phase_saving     (opt_phase_saving)
+  , chrono           (opt_chrono)
+  , confl_to_chrono  (opt_confl_to_chrono)
   , rnd_pol          (false)
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
@@ -99,21 +99,16 @@ Solver::Solver() :
     // Statistics: (formerly in 'SolverStats')
     //
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
+  , chrono_backtracks(0)
   , dec_vars(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 
   , lbd_calls(0)
-#if BRANCHING_HEURISTIC == CHB
   , action(0)
   , reward_multiplier(opt_reward_multiplier)
-#endif
 
   , ok                 (true)
-#if ! LBD_BASED_CLAUSE_DELETION
   , cla_inc            (1)
-#endif
-#if BRANCHING_HEURISTIC == VSIDS
   , var_inc            (1)
-#endif
   , watches            (WatcherDeleted(ca))
   , qhead              (0)
   , simpDB_assigns     (-1)
@@ -127,7 +122,9 @@ Solver::Solver() :
   , conflict_budget    (-1)
   , propagation_budget (-1)
   , asynch_interrupt   (false)
-{}
+{
+    selectHeuristics();
+}
 
 
 Solver::~Solver()
@@ -158,15 +155,9 @@ Var Solver::newVar(bool sign, bool dvar)
     lbd_seen.push(0);
     picked.push(0);
     conflicted.push(0);
-#if ALMOST_CONFLICT
     almost_conflicted.push(0);
-#endif
-#if ANTI_EXPLORATION
     canceled.push(0);
-#endif
-#if BRANCHING_HEURISTIC == CHB
     last_conflict.push(0);
-#endif
     total_actual_rewards.push(0);
     total_actual_count.push(0);
     setDecisionVar(v, dvar);
@@ -248,35 +239,39 @@ bool Solver::satisfied(const Clause& c) const {
 
 
 // Revert to the state at given level (keeping all assignment at 'level' but not beyond).
+// After a chronological backtrack the trail is no longer sorted by level: the assignments at or
+// below 'level' found above 'trail_lim[level]' are kept, in trail order, and propagated again.
 //
+template<class H>
 void Solver::cancelUntil(int level) {
     if (decisionLevel() > level){
+        trail_kept.clear();
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var      x  = var(trail[c]);
+            if (chrono >= 0 && this->level(x) <= level){
+                trail_kept.push(trail[c]);
+                continue; }
             uint64_t age = conflicts - picked[x];
             if (age > 0) {
                 double reward = ((double) conflicted[x]) / ((double) age);
-#if BRANCHING_HEURISTIC == LRB
-#if ALMOST_CONFLICT
-                double adjusted_reward = ((double) (conflicted[x] + almost_conflicted[x])) / ((double) age);
-#else
-                double adjusted_reward = reward;
-#endif
-                double old_activity = activity[x];
-                activity[x] = step_size * adjusted_reward + ((1 - step_size) * old_activity);
-                if (order_heap.inHeap(x)) {
-                    if (activity[x] > old_activity)
-                        order_heap.decrease(x);
-                    else
-                        order_heap.increase(x);
+                if (H::branching == LRB) {
+                    double adjusted_reward = H::almost_conflict
+                        ? ((double) (conflicted[x] + almost_conflicted[x])) / ((double) age)
+                        : reward;
+                    double old_activity = activity[x];
+                    activity[x] = step_size * adjusted_reward + ((1 - step_size) * old_activity);
+                    if (order_heap.inHeap(x)) {
+                        if (activity[x] > old_activity)
+                            order_heap.decrease(x);
+                        else
+                            order_heap.increase(x);
+                    }
                 }
-#endif
                 total_actual_rewards[x] += reward;
                 total_actual_count[x] ++;
             }
-#if ANTI_EXPLORATION
-            canceled[x] = conflicts;
-#endif
+            if (H::anti_exploration)
+                canceled[x] = conflicts;
             assigns [x] = l_Undef;
             if (phase_saving > 1 || (phase_saving == 1) && c > trail_lim.last())
                 polarity[x] = sign(trail[c]);
@@ -284,13 +279,55 @@ void Solver::cancelUntil(int level) {
         qhead = trail_lim[level];
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        for (int i = trail_kept.size()-1; i >= 0; i--)
+            trail.push_(trail_kept[i]);
     } }
 
 
+// With chronological backtracking a conflict can be below the current decision level. The literal
+// of the highest level is moved to 'c[0]' (and watched): if it is the only one of its level, the
+// clause is unit one level below and the search just backtracks there.
+//
+template<class H>
+int Solver::conflictLevel(CRef confl)
+{
+    Clause& c       = ca[confl];
+    int     highest = level(var(c[0]));
+    if (highest == decisionLevel() && level(var(c[1])) == highest)
+        return highest;
+
+    int  highest_i = 0;
+    bool one       = true;
+    for (int i = 1; i < c.size(); i++){
+        int l = level(var(c[i]));
+        if (l > highest)
+            highest = l, highest_i = i, one = true;
+        else if (l == highest)
+            one = false;
+    }
+
+    if (highest_i != 0){
+        Lit p = c[0];
+        c[0] = c[highest_i], c[highest_i] = p;
+        if (highest_i > 1){
+            remove(watches[~p], Watcher(confl, c[1]));
+            watches[~c[0]].push(Watcher(confl, c[1]));
+        }
+    }
+
+    if (one && highest > 0){
+        cancelUntil<H>(highest - 1);
+        return -1;
+    }
+    return highest;
+}
+
+
 //=================================================================================================
 // Major methods:
 
 
+template<class H>
 Lit Solver::pickBranchLit()
 {
     Var next = var_Undef;
@@ -307,20 +344,20 @@ Lit Solver::pickBranchLit()
             next = var_Undef;
             break;
         } else {
-#if ANTI_EXPLORATION
-            next = order_heap[0];
-            uint64_t age = conflicts - canceled[next];
-            while (age > 0) {
-                double decay = pow(0.95, age);
-                activity[next] *= decay;
-                if (order_heap.inHeap(next)) {
-                    order_heap.increase(next);
-                }
-                canceled[next] = conflicts;
+            if (H::anti_exploration) {
                 next = order_heap[0];
-                age = conflicts - canceled[next];
+                uint64_t age = conflicts - canceled[next];
+                while (age > 0) {
+                    double decay = pow(0.95, age);
+                    activity[next] *= decay;
+                    if (order_heap.inHeap(next)) {
+                        order_heap.increase(next);
+                    }
+                    canceled[next] = conflicts;
+                    next = order_heap[0];
+                    age = conflicts - canceled[next];
+                }
             }
-#endif
             next = order_heap.removeMin();
         }
 
@@ -344,10 +381,13 @@ Lit Solver::pickBranchLit()
 |        rest of literals. There may be others from the same level though.
 |  
 |________________________________________________________________________________________________@*/
+template<class H>
 void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 {
     int pathC = 0;
     Lit p     = lit_Undef;
+    // The conflict may be below the current decision level (see 'conflictLevel()'):
+    int confl_level = chrono >= 0 ? level(var(ca[confl][0])) : decisionLevel();
 
     // Generate conflict clause:
     //
@@ -358,35 +398,34 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         assert(confl != CRef_Undef); // (otherwise should be UIP)
         Clause& c = ca[confl];
 
-#if LBD_BASED_CLAUSE_DELETION
-        if (c.learnt() && c.activity() > 2)
-            c.activity() = lbd(c);
-#else
-        if (c.learnt())
+        if (H::lbd_deletion){
+            if (c.learnt() && c.lbd() > 2)
+                c.lbd() = lbd(c);
+        }else if (c.learnt())
             claBumpActivity(c);
-#endif
 
         for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
             Lit q = c[j];
 
             if (!seen[var(q)] && level(var(q)) > 0){
-#if BRANCHING_HEURISTIC == CHB
-                last_conflict[var(q)] = conflicts;
-#elif BRANCHING_HEURISTIC == VSIDS
-                varBumpActivity(var(q));
-#endif
+                if (H::branching == CHB)
+                    last_conflict[var(q)] = conflicts;
+                else if (H::branching == VSIDS)
+                    varBumpActivity(var(q));
                 conflicted[var(q)]++;
                 seen[var(q)] = 1;
-                if (level(var(q)) >= decisionLevel())
+                if (level(var(q)) >= confl_level)
                     pathC++;
                 else
                     out_learnt.push(q);
             }
         }
         
-        // Select next clause to look at:
-        while (!seen[var(trail[index--])]);
-        p     = trail[index+1];
+        // Select next clause to look at (skipping the lower levels out of order on the trail):
+        do{
+            while (!seen[var(trail[index--])]);
+            p     = trail[index+1];
+        }while (level(var(p)) < confl_level);
         confl = reason(var(p));
         seen[var(p)] = 0;
         pathC--;
@@ -445,24 +484,24 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         out_btlevel       = level(var(p));
     }
 
-#if ALMOST_CONFLICT
-    seen[var(p)] = true;
-    for(int i = out_learnt.size() - 1; i >= 0; i--) {
-        Var v = var(out_learnt[i]);
-        CRef rea = reason(v);
-        if (rea != CRef_Undef) {
-            Clause& reaC = ca[rea];
-            for (int i = 0; i < reaC.size(); i++) {
-                Lit l = reaC[i];
-                if (!seen[var(l)]) {
-                    seen[var(l)] = true;
-                    almost_conflicted[var(l)]++;
-                    analyze_toclear.push(l);
+    if (H::almost_conflict) {
+        seen[var(p)] = true;
+        for(int i = out_learnt.size() - 1; i >= 0; i--) {
+            Var v = var(out_learnt[i]);
+            CRef rea = reason(v);
+            if (rea != CRef_Undef) {
+                Clause& reaC = ca[rea];
+                for (int i = 0; i < reaC.size(); i++) {
+                    Lit l = reaC[i];
+                    if (!seen[var(l)]) {
+                        seen[var(l)] = true;
+                        almost_conflicted[var(l)]++;
+                        analyze_toclear.push(l);
+                    }
                 }
             }
         }
     }
-#endif
     for (int j = 0; j < analyze_toclear.size(); j++) seen[var(analyze_toclear[j])] = 0;    // ('seen[]' is now cleared)
 }
 
@@ -537,26 +576,33 @@ void Solver::analyzeFinal(Lit p, vec<Lit>& out_conflict)
 }
 
 
+template<class H>
 void Solver::uncheckedEnqueue(Lit p, CRef from)
+{
+    uncheckedEnqueue<H>(p, decisionLevel(), from);
+}
+
+
+template<class H>
+void Solver::uncheckedEnqueue(Lit p, int level, CRef from)
 {
     assert(value(p) == l_Undef);
     picked[var(p)] = conflicts;
-#if ANTI_EXPLORATION
-    uint64_t age = conflicts - canceled[var(p)];
-    if (age > 0) {
-        double decay = pow(0.95, age);
-        activity[var(p)] *= decay;
-        if (order_heap.inHeap(var(p))) {
-            order_heap.increase(var(p));
+    if (H::anti_exploration) {
+        uint64_t age = conflicts - canceled[var(p)];
+        if (age > 0) {
+            double decay = pow(0.95, age);
+            activity[var(p)] *= decay;
+            if (order_heap.inHeap(var(p))) {
+                order_heap.increase(var(p));
+            }
         }
     }
-#endif
     conflicted[var(p)] = 0;
-#if ALMOST_CONFLICT
-    almost_conflicted[var(p)] = 0;
-#endif
+    if (H::almost_conflict)
+        almost_conflicted[var(p)] = 0;
     assigns[var(p)] = lbool(!sign(p));
-    vardata[var(p)] = mkVarData(from, decisionLevel());
+    vardata[var(p)] = mkVarData(from, level);
     trail.push_(p);
 }
 
@@ -572,6 +618,7 @@ void Solver::uncheckedEnqueue(Lit p, CRef from)
 |    Post-conditions:
 |      * the propagation queue is empty, even if there was a conflict.
 |________________________________________________________________________________________________@*/
+template<class H>
 CRef Solver::propagate()
 {
     CRef    confl     = CRef_Undef;
@@ -580,6 +627,7 @@ CRef Solver::propagate()
 
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
+        int            p_level = level(var(p));  // (below the decision level only out of order, see 'chrono')
         vec<Watcher>&  ws  = watches[p];
         Watcher        *i, *j, *end;
         num_props++;
@@ -620,8 +668,21 @@ CRef Solver::propagate()
                 // Copy the remaining watches:
                 while (i < end)
                     *j++ = *i++;
-            }else
-                uncheckedEnqueue(first, cr);
+            }else if (p_level == decisionLevel())
+                uncheckedEnqueue<H>(first, cr);
+            else{
+                // Out of order (see 'chrono'): the implication is at the highest level of the
+                // other literals, one of which takes over the watch
+                int max_k = 1;
+                for (int k = 2; k < c.size(); k++)
+                    if (level(var(c[k])) > level(var(c[max_k])))
+                        max_k = k;
+                if (max_k != 1){
+                    c[1] = c[max_k]; c[max_k] = false_lit;
+                    j--;
+                    watches[~c[1]].push(w); }
+                uncheckedEnqueue<H>(first, level(var(c[1])), cr);
+            }
 
         NextClause:;
         }
@@ -647,41 +708,32 @@ int min(int a, int b) {
 |________________________________________________________________________________________________@*/
 struct reduceDB_lt { 
     ClauseAllocator& ca;
-#if LBD_BASED_CLAUSE_DELETION
-    vec<double>& activity;
-    reduceDB_lt(ClauseAllocator& ca_,vec<double>& activity_) : ca(ca_), activity(activity_) {}
-#else
     reduceDB_lt(ClauseAllocator& ca_) : ca(ca_) {}
-#endif
     bool operator () (CRef x, CRef y) { 
-#if LBD_BASED_CLAUSE_DELETION
-        return ca[x].activity() > ca[y].activity();
-    }
-#else
         return ca[x].size() > 2 && (ca[y].size() == 2 || ca[x].activity() < ca[y].activity()); } 
-#endif
+};
+struct reduceDB_lbd_lt { 
+    ClauseAllocator& ca;
+    reduceDB_lbd_lt(ClauseAllocator& ca_) : ca(ca_) {}
+    bool operator () (CRef x, CRef y) { 
+        return ca[x].lbd() > ca[y].lbd(); }
 };
 void Solver::reduceDB()
 {
     int     i, j;
-#if LBD_BASED_CLAUSE_DELETION
-    sort(learnts, reduceDB_lt(ca, activity));
-#else
     double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
-    sort(learnts, reduceDB_lt(ca));
-#endif
+    if (lbd_deletion)
+        sort(learnts, reduceDB_lbd_lt(ca));
+    else
+        sort(learnts, reduceDB_lt(ca));
 
     // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
-    // and clauses with activity smaller than 'extra_lim':
-#if LBD_BASED_CLAUSE_DELETION
+    // and clauses with activity smaller than 'extra_lim' (with LBD deletion: clauses of LBD > 2
+    // from the first half):
     for (i = j = 0; i < learnts.size(); i++){
         Clause& c = ca[learnts[i]];
-        if (c.activity() > 2 && !locked(c) && i < learnts.size() / 2)
-#else
-    for (i = j = 0; i < learnts.size(); i++){
-        Clause& c = ca[learnts[i]];
-        if (c.size() > 2 && !locked(c) && (i < learnts.size() / 2 || c.activity() < extra_lim))
-#endif
+        if (lbd_deletion ? c.lbd() > 2 && !locked(c) && i < learnts.size() / 2
+                         : c.size() > 2 && !locked(c) && (i < learnts.size() / 2 || c.activity() < extra_lim))
             removeClause(learnts[i]);
         else
             learnts[j++] = learnts[i];
@@ -759,6 +811,7 @@ bool Solver::simplify()
 |    all variables are decision variables, this means that the clause set is satisfiable. 'l_False'
 |    if the clause set is unsatisfiable. 'l_Undef' if the bound on number of conflicts is reached.
 |________________________________________________________________________________________________@*/
+template<class H>
 lbool Solver::search(int nof_conflicts)
 {
     assert(ok);
@@ -768,70 +821,72 @@ lbool Solver::search(int nof_conflicts)
     starts++;
 
     for (;;){
-        CRef confl = propagate();
-
-#if BRANCHING_HEURISTIC == CHB
-        double multiplier = confl == CRef_Undef ? reward_multiplier : 1.0;
-        for (int a = action; a < trail.size(); a++) {
-            Var v = var(trail[a]);
-            uint64_t age = conflicts - last_conflict[v] + 1;
-            double reward = multiplier / age ;
-            double old_activity = activity[v];
-            activity[v] = step_size * reward + ((1 - step_size) * old_activity);
-            if (order_heap.inHeap(v)) {
-                if (activity[v] > old_activity)
-                    order_heap.decrease(v);
-                else
-                    order_heap.increase(v);
+        CRef confl = propagate<H>();
+
+        if (H::branching == CHB) {
+            double multiplier = confl == CRef_Undef ? reward_multiplier : 1.0;
+            for (int a = action; a < trail.size(); a++) {
+                Var v = var(trail[a]);
+                uint64_t age = conflicts - last_conflict[v] + 1;
+                double reward = multiplier / age ;
+                double old_activity = activity[v];
+                activity[v] = step_size * reward + ((1 - step_size) * old_activity);
+                if (order_heap.inHeap(v)) {
+                    if (activity[v] > old_activity)
+                        order_heap.decrease(v);
+                    else
+                        order_heap.increase(v);
+                }
             }
         }
-#endif
         if (confl != CRef_Undef){
             // CONFLICT
             conflicts++; conflictC++;
-#if BRANCHING_HEURISTIC == CHB || BRANCHING_HEURISTIC == LRB
-            if (step_size > min_step_size)
+            if (H::branching != VSIDS && step_size > min_step_size)
                 step_size -= step_size_dec;
-#endif
-            if (decisionLevel() == 0) return l_False;
+            int confl_level = decisionLevel();
+            if (chrono >= 0 && confl_level > 0 && (confl_level = conflictLevel<H>(confl)) < 0){
+                if (H::branching == CHB)
+                    action = trail.size();
+                continue; }
+            if (confl_level == 0) return l_False;
 
             learnt_clause.clear();
-            analyze(confl, learnt_clause, backtrack_level);
+            analyze<H>(confl, learnt_clause, backtrack_level);
 
-            cancelUntil(backtrack_level);
+            if (chrono >= 0 && conflicts >= (uint64_t)confl_to_chrono && decisionLevel() - backtrack_level >= chrono){
+                chrono_backtracks++;
+                cancelUntil<H>(confl_level - 1);
+            }else
+                cancelUntil<H>(backtrack_level);
 
-#if BRANCHING_HEURISTIC == CHB
-            action = trail.size();
-#endif
+            if (H::branching == CHB)
+                action = trail.size();
 
             if (learnt_clause.size() == 1){
-                uncheckedEnqueue(learnt_clause[0]);
+                uncheckedEnqueue<H>(learnt_clause[0], 0, CRef_Undef);
             }else{
                 CRef cr = ca.alloc(learnt_clause, true);
                 learnts.push(cr);
                 attachClause(cr);
-#if LBD_BASED_CLAUSE_DELETION
-                Clause& clause = ca[cr];
-                clause.activity() = lbd(clause);
-#else
-                claBumpActivity(ca[cr]);
-#endif
-                uncheckedEnqueue(learnt_clause[0], cr);
+                if (H::lbd_deletion){
+                    Clause& clause = ca[cr];
+                    clause.lbd() = lbd(clause);
+                }else
+                    claBumpActivity(ca[cr]);
+                uncheckedEnqueue<H>(learnt_clause[0], backtrack_level, cr);
             }
 
-#if BRANCHING_HEURISTIC == VSIDS
-            varDecayActivity();
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
-            claDecayActivity();
-#endif
+            if (H::branching == VSIDS)
+                varDecayActivity();
+            if (!H::lbd_deletion)
+                claDecayActivity();
 
             if (--learntsize_adjust_cnt == 0){
                 learntsize_adjust_confl *= learntsize_adjust_inc;
                 learntsize_adjust_cnt    = (int)learntsize_adjust_confl;
-#if ! RAPID_DELETION
-                max_learnts             *= learntsize_inc;
-#endif
+                if (!rapid_deletion)
+                    max_learnts         *= learntsize_inc;
 
                 if (verbosity >= 1)
                     printf("| %9d | %7d %8d %8d | %8d %8d %6.0f | %6.3f %% |\n", 
@@ -845,7 +900,7 @@ lbool Solver::search(int nof_conflicts)
             if (nof_conflicts >= 0 && conflictC >= nof_conflicts || !withinBudget()){
                 // Reached bound on number of conflicts:
                 progress_estimate = progressEstimate();
-                cancelUntil(0);
+                cancelUntil<H>(0);
                 return l_Undef; }
 
             // Simplify the set of problem clauses:
@@ -855,9 +910,8 @@ lbool Solver::search(int nof_conflicts)
             if (learnts.size()-nAssigns() >= max_learnts) {
                 // Reduce the set of learnt clauses:
                 reduceDB();
-#if RAPID_DELETION
-                max_learnts += 500;
-#endif
+                if (rapid_deletion)
+                    max_learnts += 500;
             }
 
             Lit next = lit_Undef;
@@ -879,7 +933,7 @@ lbool Solver::search(int nof_conflicts)
             if (next == lit_Undef){
                 // New variable decision:
                 decisions++;
-                next = pickBranchLit();
+                next = pickBranchLit<H>();
 
                 if (next == lit_Undef)
                     // Model found:
@@ -888,10 +942,9 @@ lbool Solver::search(int nof_conflicts)
 
             // Increase decision level and enqueue 'next'
             newDecisionLevel();
-#if BRANCHING_HEURISTIC == CHB
-            action = trail.size();
-#endif
-            uncheckedEnqueue(next);
+            if (H::branching == CHB)
+                action = trail.size();
+            uncheckedEnqueue<H>(next);
         }
     }
 }
@@ -947,21 +1000,19 @@ lbool Solver::solve_()
     if (!ok) return l_False;
 
     solves++;
+    selectHeuristics();
 
-#if RAPID_DELETION
-    max_learnts               = 2000;
-#else
-    max_learnts               = nClauses() * learntsize_factor;
-#endif
+    max_learnts               = rapid_deletion ? 2000 : nClauses() * learntsize_factor;
     learntsize_adjust_confl   = learntsize_adjust_start_confl;
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
     lbool   status            = l_Undef;
 
     if (verbosity >= 1){
-        printf("LBD Based Clause Deletion : %d\n", LBD_BASED_CLAUSE_DELETION);
-        printf("Rapid Deletion : %d\n", RAPID_DELETION);
-        printf("Almost Conflict : %d\n", ALMOST_CONFLICT);
-        printf("Anti Exploration : %d\n", ANTI_EXPLORATION);
+        printf("Branching Heuristic : %s\n", branching == VSIDS ? "VSIDS" : branching == CHB ? "CHB" : "LRB");
+        printf("LBD Based Clause Deletion : %d\n", lbd_deletion);
+        printf("Rapid Deletion : %d\n", rapid_deletion);
+        printf("Almost Conflict : %d\n", almost_conflict);
+        printf("Anti Exploration : %d\n", anti_exploration);
         printf("============================[ Search Statistics ]==============================\n");
         printf("| Conflicts |          ORIGINAL         |          LEARNT          | Progress |\n");
         printf("|           |    Vars  Clauses Literals |    Limit  Clauses Lit/Cl |          |\n");
@@ -992,6 +1043,46 @@ lbool Solver::solve_()
     return status;
 }
 
+//=================================================================================================
+// Heuristic selection:
+//
+// 'search()' and the methods it calls in the hot path are instantiated for every valid combination
+// of the heuristic options; the plain versions of 'search()', 'propagate()', 'cancelUntil()' and
+// 'uncheckedEnqueue()' call the instantiation bound here.
+
+
+template<class H>
+void Solver::bindHeuristics()
+{
+    search_fn           = &Solver::search<H>;
+    propagate_fn        = &Solver::propagate<H>;
+    cancelUntil_fn      = &Solver::cancelUntil<H>;
+    uncheckedEnqueue_fn = &Solver::uncheckedEnqueue<H>;
+}
+
+
+template<int B, bool AC, bool AE>
+void Solver::bindDeletion()
+{
+    if (lbd_deletion) bindHeuristics<Heuristics<B, true,  AC, AE> >();
+    else              bindHeuristics<Heuristics<B, false, AC, AE> >();
+}
+
+
+void Solver::selectHeuristics()
+{
+    // Almost conflict and anti exploration are refinements of LRB:
+    if (branching != LRB)
+        almost_conflict = anti_exploration = false;
+
+    if      (branching == VSIDS)                   bindDeletion<VSIDS, false, false>();
+    else if (branching == CHB)                     bindDeletion<CHB,   false, false>();
+    else if (almost_conflict && anti_exploration)  bindDeletion<LRB,   true,  true >();
+    else if (almost_conflict)                      bindDeletion<LRB,   true,  false>();
+    else if (anti_exploration)                     bindDeletion<LRB,   false, true >();
+    else                                           bindDeletion<LRB,   false, false>();
+}
+
 //=================================================================================================
 // Writing CNF to DIMACS:
 // 
@@ -36,6 +36,8 @@ namespace Minisat {
 class Solver {
 public:
 
+    enum { VSIDS = 0, CHB = 1, LRB = 2 };  // Branching heuristics, see 'branching'.
+
     // Constructor/Destructor:
     //
     Solver();
@@ -114,22 +116,23 @@ public:
     // Mode of operation:
     //
     int       verbosity;
-#if BRANCHING_HEURISTIC == CHB || BRANCHING_HEURISTIC == LRB
+    int       branching;          // Branching heuristic (VSIDS, CHB or LRB).
+    bool      lbd_deletion;       // Rank learnt clauses by their LBD instead of their activity.
+    bool      rapid_deletion;     // Raise the learnt clause limit by 500 after each reduction instead of geometrically.
+    bool      almost_conflict;    // LRB only: also reward the variables of the reasons of the learnt clause.
+    bool      anti_exploration;   // LRB only: decay the activity of a variable for the conflicts it stayed unassigned.
     double    step_size;
     double    step_size_dec;
     double    min_step_size;
-#endif
-#if BRANCHING_HEURISTIC == VSIDS
     double    var_decay;
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
     double    clause_decay;
-#endif
     double    random_var_freq;
     double    random_seed;
     bool      luby_restart;
     int       ccmin_mode;         // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
     int       phase_saving;       // Controls the level of phase saving (0=none, 1=limited, 2=full).
+    int       chrono;             // Backjumps over more levels than this backtrack chronologically instead (-1=never).
+    int       confl_to_chrono;    // Number of conflicts before backtracking chronologically.
     bool      rnd_pol;            // Use random polarities for branching heuristics.
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
@@ -145,23 +148,18 @@ public:
     // Statistics: (read-only member variable)
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
+    uint64_t chrono_backtracks;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
 
     uint64_t lbd_calls;
     vec<uint64_t> lbd_seen;
     vec<uint64_t> picked;
     vec<uint64_t> conflicted;
-#if ALMOST_CONFLICT
     vec<uint64_t> almost_conflicted;
-#endif
-#if ANTI_EXPLORATION
     vec<uint64_t> canceled;
-#endif
-#if BRANCHING_HEURISTIC == CHB
     vec<uint64_t> last_conflict;
     int action;
     double reward_multiplier;
-#endif
 
     vec<long double> total_actual_rewards;
     vec<int> total_actual_count;
@@ -188,6 +186,17 @@ protected:
         bool operator()(const Watcher& w) const { return ca[w.cref].mark() == 1; }
     };
 
+    // The heuristics one instantiation of the search loop is compiled for (see 'selectHeuristics()'),
+    // so that the hot path does not branch on them:
+    //
+    template<int Branching, bool LbdDeletion, bool AlmostConflict, bool AntiExploration>
+    struct Heuristics {
+        static const int  branching        = Branching;
+        static const bool lbd_deletion     = LbdDeletion;
+        static const bool almost_conflict  = AlmostConflict;
+        static const bool anti_exploration = AntiExploration;
+    };
+
     struct VarOrderLt {
         const vec<double>&  activity;
         bool operator () (Var x, Var y) const { return activity[x] > activity[y]; }
@@ -199,9 +208,7 @@ protected:
     bool                ok;               // If FALSE, the constraints are already unsatisfiable. No part of the solver state may be used!
     vec<CRef>           clauses;          // List of problem clauses.
     vec<CRef>           learnts;          // List of learnt clauses.
-#if ! LBD_BASED_CLAUSE_DELETION
     double              cla_inc;          // Amount to bump next clause with.
-#endif
     vec<double>         activity;         // A heuristic measurement of the activity of a variable.
     double              var_inc;          // Amount to bump next variable with.
     OccLists<Lit, vec<Watcher>, WatcherDeleted>
@@ -229,6 +236,7 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<Lit>            trail_kept;       // Assignments below the target level that 'cancelUntil()' keeps.
 
     double              max_learnts;
     double              learntsize_adjust_confl;
@@ -240,16 +248,31 @@ protected:
     int64_t             propagation_budget; // -1 means no budget.
     bool                asynch_interrupt;
 
+    // Instantiations of the templated methods for the selected heuristics:
+    //
+    lbool    (Solver::*search_fn)           (int nof_conflicts);
+    CRef     (Solver::*propagate_fn)        ();
+    void     (Solver::*cancelUntil_fn)      (int level);
+    void     (Solver::*uncheckedEnqueue_fn) (Lit p, CRef from);
+
     // Main internal methods:
     //
+    void     selectHeuristics ();                                                      // Bind the instantiations for the heuristics chosen by the options.
+    template<class H> void bindHeuristics ();
+    template<int B, bool AC, bool AE> void bindDeletion ();
     void     insertVarOrder   (Var x);                                                 // Insert a variable in the decision order priority queue.
-    Lit      pickBranchLit    ();                                                      // Return the next decision variable.
+    template<class H> Lit pickBranchLit ();                                            // Return the next decision variable.
     void     newDecisionLevel ();                                                      // Begins a new decision level.
     void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef);                         // Enqueue a literal. Assumes value of literal is undefined.
+    template<class H> void uncheckedEnqueue (Lit p, CRef from = CRef_Undef);
+    template<class H> void uncheckedEnqueue (Lit p, int level, CRef from);            // Enqueue a literal at a level that may be below the current one.
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     CRef     propagate        ();                                                      // Perform unit propagation. Returns possibly conflicting clause.
+    template<class H> CRef propagate ();
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
-    void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
+    template<class H> void cancelUntil (int level);
+    template<class H> int conflictLevel (CRef confl);                                  // Level of a conflict, or -1 after backtracking below a missed implication.
+    template<class H> void analyze (CRef confl, vec<Lit>& out_learnt, int& out_btlevel); // (bt = backtrack)
     void     analyzeFinal     (Lit p, vec<Lit>& out_conflict);                         // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p, uint32_t abstract_levels);                       // (helper method for 'analyze()')
 
@@ -266,6 +289,7 @@ protected:
         return lbd;
     }
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
+    template<class H> lbool search (int nof_conflicts);
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
@@ -273,15 +297,11 @@ protected:
 
     // Maintaining Variable/Clause activity:
     //
-#if BRANCHING_HEURISTIC == VSIDS
     void     varDecayActivity ();                      // Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
     void     varBumpActivity  (Var v, double inc);     // Increase a variable with the current 'bump' value.
     void     varBumpActivity  (Var v);                 // Increase a variable with the current 'bump' value.
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
     void     claDecayActivity ();                      // Decay all clauses with the specified factor. Implemented by increasing the 'bump' value instead.
     void     claBumpActivity  (Clause& c);             // Increase a clause with the current 'bump' value.
-#endif
 
     // Operations on clauses:
     //
@@ -327,7 +347,6 @@ inline int  Solver::level (Var x) const { return vardata[x].level; }
 inline void Solver::insertVarOrder(Var x) {
     if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
 
-#if BRANCHING_HEURISTIC == VSIDS
 inline void Solver::varDecayActivity() { var_inc *= (1 / var_decay); }
 inline void Solver::varBumpActivity(Var v) { varBumpActivity(v, var_inc); }
 inline void Solver::varBumpActivity(Var v, double inc) {
@@ -340,8 +359,6 @@ inline void Solver::varBumpActivity(Var v, double inc) {
     // Update order_heap with respect to new activity:
     if (order_heap.inHeap(v))
         order_heap.decrease(v); }
-#endif
-#if ! LBD_BASED_CLAUSE_DELETION
 inline void Solver::claDecayActivity() { cla_inc *= (1 / clause_decay); }
 inline void Solver::claBumpActivity (Clause& c) {
         if ( (c.activity() += cla_inc) > 1e20 ) {
@@ -349,7 +366,11 @@ inline void Solver::claBumpActivity (Clause& c) {
             for (int i = 0; i < learnts.size(); i++)
                 ca[learnts[i]].activity() *= 1e-20;
             cla_inc *= 1e-20; } }
-#endif
+
+inline lbool Solver::search          (int nof_conflicts)  { return (this->*search_fn)(nof_conflicts); }
+inline CRef  Solver::propagate       ()                   { return (this->*propagate_fn)(); }
+inline void  Solver::cancelUntil     (int level)          { (this->*cancelUntil_fn)(level); }
+inline void  Solver::uncheckedEnqueue(Lit p, CRef from)   { (this->*uncheckedEnqueue_fn)(p, from); }
 
 inline void Solver::checkGarbage(void){ return checkGarbage(garbage_frac); }
 inline void Solver::checkGarbage(double gf){
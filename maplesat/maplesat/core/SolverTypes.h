@@ -22,36 +22,6 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef Minisat_SolverTypes_h
 #define Minisat_SolverTypes_h
 
-#define VSIDS 0
-#define CHB 1
-#define LRB 2
-
-#ifndef BRANCHING_HEURISTIC
-    #define BRANCHING_HEURISTIC LRB
-#endif
-
-#ifndef LBD_BASED_CLAUSE_DELETION
-    #define LBD_BASED_CLAUSE_DELETION true
-#endif
-
-#ifndef RAPID_DELETION
-    #define RAPID_DELETION true
-#endif
-
-#ifndef ALMOST_CONFLICT
-    #define ALMOST_CONFLICT true
-#endif
-#if ALMOST_CONFLICT && BRANCHING_HEURISTIC != LRB
-    #error ALMOST_CONFLICT requires BRANCHING_HEURISTIC == LRB
-#endif
-
-#ifndef ANTI_EXPLORATION
-    #define ANTI_EXPLORATION true
-#endif
-#if ANTI_EXPLORATION && BRANCHING_HEURISTIC != LRB
-    #error ANTI_EXPLORATION requires BRANCHING_HEURISTIC == LRB
-#endif
-
 #include <assert.h>
 
 #include "mtl/IntTypes.h"
@@ -72,12 +42,6 @@ namespace Minisat {
 typedef int Var;
 #define var_Undef (-1)
 
-#if LBD_BASED_CLAUSE_DELETION
-typedef int Act;
-#else
-typedef float Act;
-#endif
-
 struct Lit {
     int     x;
 
@@ -162,7 +126,7 @@ class Clause {
         unsigned has_extra : 1;
         unsigned reloced   : 1;
         unsigned size      : 27; }                            header;
-    union { Lit lit; Act act; uint32_t abs; CRef rel; } data[0];
+    union { Lit lit; float act; int lbd; uint32_t abs; CRef rel; } data[0];
 
     friend class ClauseAllocator;
 
@@ -213,7 +177,8 @@ public:
     Lit          operator [] (int i) const   { return data[i].lit; }
     operator const Lit* (void) const         { return (Lit*)data; }
 
-    Act&         activity    ()              { assert(header.has_extra); return data[header.size].act; }
+    float&       activity    ()              { assert(header.has_extra); return data[header.size].act; }
+    int&         lbd         ()              { assert(header.has_extra); return data[header.size].lbd; } // (shares the word of 'activity')
     uint32_t     abstraction () const        { assert(header.has_extra); return data[header.size].abs; }
 
     Lit          subsumes    (const Clause& other) const;
@@ -278,7 +243,7 @@ class ClauseAllocator : public RegionAllocator<uint32_t>
         // Copy extra data-fields: 
         // (This could be cleaned-up. Generalize Clause-constructor to be applicable here instead?)
         to[cr].mark(c.mark());
-        if (to[cr].learnt())         to[cr].activity() = c.activity();
+        if (to[cr].learnt())         to[cr].data[to[cr].size()].abs = c.data[c.size()].abs; // (activity or LBD)
         else if (to[cr].has_extra()) to[cr].calcAbstraction();
     }
 };